@@ -0,0 +1,479 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include "atlas.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+//
+// integer hls conversion, produces the same values as the shell
+// ColorRGBToHLS/ColorHLSToRGB functions, but does not depend on them.
+//
+
+#define HLS_RED(clr) ((LONG)((clr) & 0xFF))
+#define HLS_GREEN(clr) ((LONG)(((clr) >> 8) & 0xFF))
+#define HLS_BLUE(clr) ((LONG)(((clr) >> 16) & 0xFF))
+
+#define HLS_RGB(r, g, b) ((COLORREF)((r) | ((g) << 8) | ((b) << 16)))
+
+VOID AtlasRGBToHLS (
+	_In_ COLORREF clr,
+	_Out_ PUSHORT hue,
+	_Out_ PUSHORT lightness,
+	_Out_ PUSHORT saturation
+)
+{
+	LONG r, g, b;
+	LONG max_value, min_value;
+	LONG delta;
+	LONG r_norm, g_norm, b_norm;
+	LONG h, l, s;
+
+	r = HLS_RED (clr);
+	g = HLS_GREEN (clr);
+	b = HLS_BLUE (clr);
+
+	max_value = r > g ? r : g;
+	max_value = max_value > b ? max_value : b;
+
+	min_value = r < g ? r : g;
+	min_value = min_value < b ? min_value : b;
+
+	l = ((max_value + min_value) * ATLAS_HLS_MAX + 255) / 510;
+
+	if (max_value == min_value)
+	{
+		// achromatic, the hue is undefined but this is what shell returns
+		s = 0;
+		h = 160;
+	}
+	else
+	{
+		delta = max_value - min_value;
+
+		if (l <= (ATLAS_HLS_MAX / 2))
+		{
+			s = ((max_value + min_value) / 2 + delta * ATLAS_HLS_MAX) / (max_value + min_value);
+		}
+		else
+		{
+			s = ((510 - max_value - min_value) / 2 + delta * ATLAS_HLS_MAX) / (510 - max_value - min_value);
+		}
+
+		r_norm = (delta / 2 + max_value * 40 - r * 40) / delta;
+		g_norm = (delta / 2 + max_value * 40 - g * 40) / delta;
+		b_norm = (delta / 2 + max_value * 40 - b * 40) / delta;
+
+		if (r == max_value)
+		{
+			h = b_norm - g_norm;
+		}
+		else if (g == max_value)
+		{
+			h = 80 + r_norm - b_norm;
+		}
+		else
+		{
+			h = 160 + g_norm - r_norm;
+		}
+
+		if (h < 0)
+		{
+			h += ATLAS_HUE_PERIOD;
+		}
+		else if (h > ATLAS_HUE_PERIOD)
+		{
+			h -= ATLAS_HUE_PERIOD;
+		}
+	}
+
+	*hue = (USHORT)h;
+	*lightness = (USHORT)l;
+	*saturation = (USHORT)s;
+}
+
+FORCEINLINE LONG HueToChannel (
+	_In_ LONG hue,
+	_In_ LONG mid1,
+	_In_ LONG mid2
+)
+{
+	LONG value;
+
+	if (hue > ATLAS_HUE_PERIOD)
+	{
+		hue -= ATLAS_HUE_PERIOD;
+	}
+	else if (hue < 0)
+	{
+		hue += ATLAS_HUE_PERIOD;
+	}
+
+	if (hue > 160)
+	{
+		value = mid1;
+	}
+	else if (hue > 120)
+	{
+		value = ((((160 - hue) * (mid2 - mid1)) + 20) / 40) + mid1;
+	}
+	else if (hue > 40)
+	{
+		value = mid2;
+	}
+	else
+	{
+		value = (((hue * (mid2 - mid1)) + 20) / 40) + mid1;
+	}
+
+	return (value * 255 + 120) / ATLAS_HLS_MAX;
+}
+
+COLORREF AtlasHLSToRGB (
+	_In_ USHORT hue,
+	_In_ USHORT lightness,
+	_In_ USHORT saturation
+)
+{
+	LONG mid1, mid2;
+	LONG value;
+
+	if (!saturation)
+	{
+		value = (lightness * 255) / ATLAS_HLS_MAX;
+
+		return HLS_RGB (value, value, value);
+	}
+
+	if (lightness > (ATLAS_HLS_MAX / 2))
+	{
+		mid2 = saturation + lightness - ((saturation * lightness) + (ATLAS_HLS_MAX / 2)) / ATLAS_HLS_MAX;
+	}
+	else
+	{
+		mid2 = (((saturation + ATLAS_HLS_MAX) * lightness) + (ATLAS_HLS_MAX / 2)) / ATLAS_HLS_MAX;
+	}
+
+	mid1 = lightness * 2 - mid2;
+
+	return HLS_RGB (
+		HueToChannel (hue + 80, mid1, mid2),
+		HueToChannel (hue, mid1, mid2),
+		HueToChannel (hue - 80, mid1, mid2)
+	);
+}
+
+VOID AtlasInitializePalette (
+	_Out_ PATLAS_PALETTE palette,
+	_In_reads_ (count) CONST COLORREF *colors,
+	_In_ ULONG count
+)
+{
+	USHORT hue;
+
+	RtlZeroMemory (palette, sizeof (ATLAS_PALETTE));
+
+	if (count > ATLAS_PALETTE_SIZE)
+		count = ATLAS_PALETTE_SIZE;
+
+	for (ULONG i = 0; i < count; i++)
+		AtlasRGBToHLS (colors[i], &hue, &palette->lightness[i], &palette->saturation[i]);
+}
+
+//
+// recolour only the palette, the pixels are expanded through the
+// resulting table so a hue change costs 256 conversions.
+//
+VOID AtlasRecolorPalette (
+	_In_ PCATLAS_PALETTE palette,
+	_In_ LONG hue,
+	_Out_writes_ (ATLAS_PALETTE_SIZE) PULONG lut
+)
+{
+	for (ULONG i = 0; i < ATLAS_PALETTE_SIZE; i++)
+		lut[i] = AtlasHLSToRGB ((USHORT)hue, palette->lightness[i], palette->saturation[i]);
+}
+
+VOID AtlasExpandPixels (
+	_In_reads_ (count) CONST UCHAR *src,
+	_In_reads_ (ATLAS_PALETTE_SIZE) CONST ULONG *lut,
+	_Out_writes_ (count) PULONG dest,
+	_In_ SIZE_T count
+)
+{
+	SIZE_T i = 0;
+
+#if defined(__AVX2__)
+	__m128i indices;
+
+	// widen 8 indices at a time and gather them from the table
+	for (; i + 8 <= count; i += 8)
+	{
+		indices = _mm_loadl_epi64 ((CONST __m128i *)(src + i));
+
+		_mm256_storeu_si256 (
+			(__m256i *)(dest + i),
+			_mm256_i32gather_epi32 ((CONST INT *)lut, _mm256_cvtepu8_epi32 (indices), sizeof (ULONG))
+		);
+	}
+#else
+	for (; i + 8 <= count; i += 8)
+	{
+		dest[i + 0] = lut[src[i + 0]];
+		dest[i + 1] = lut[src[i + 1]];
+		dest[i + 2] = lut[src[i + 2]];
+		dest[i + 3] = lut[src[i + 3]];
+		dest[i + 4] = lut[src[i + 4]];
+		dest[i + 5] = lut[src[i + 5]];
+		dest[i + 6] = lut[src[i + 6]];
+		dest[i + 7] = lut[src[i + 7]];
+	}
+#endif // __AVX2__
+
+	for (; i < count; i++)
+		dest[i] = lut[src[i]];
+}
+
+VOID AtlasRecolor (
+	_In_ PCATLAS_SOURCE source,
+	_In_ LONG hue,
+	_Out_writes_ (source->width * source->height) PULONG dest
+)
+{
+	ULONG lut[ATLAS_PALETTE_SIZE];
+
+	AtlasRecolorPalette (&source->palette, hue, lut);
+
+	AtlasExpandPixels (source->pixels, lut, dest, (SIZE_T)source->width * source->height);
+}
+
+FORCEINLINE SIZE_T AtlasGetBlobPixelsOffset ()
+{
+	return PLATFORM_ALIGN_UP (sizeof (ATLAS_BLOB_HEADER), ATLAS_BLOB_ALIGNMENT);
+}
+
+SIZE_T AtlasGetBlobSize (
+	_In_ PCATLAS_SOURCE source
+)
+{
+	return AtlasGetBlobPixelsOffset () + PLATFORM_ALIGN_UP ((SIZE_T)source->width * source->height, ATLAS_BLOB_ALIGNMENT);
+}
+
+BOOLEAN AtlasSaveBlob (
+	_In_ PCATLAS_SOURCE source,
+	_Out_writes_bytes_ (size) PVOID buffer,
+	_In_ SIZE_T size
+)
+{
+	PATLAS_BLOB_HEADER header;
+
+	if (size < AtlasGetBlobSize (source))
+		return FALSE;
+
+	// padding is zeroed so the same sheet always gives the same blob
+	RtlZeroMemory (buffer, size);
+
+	header = buffer;
+
+	header->magic = ATLAS_BLOB_MAGIC;
+	header->version = ATLAS_BLOB_VERSION;
+	header->width = source->width;
+	header->height = source->height;
+	header->pixels_offset = (ULONG)AtlasGetBlobPixelsOffset ();
+	header->pixels_size = source->width * source->height;
+
+	RtlCopyMemory (&header->palette, &source->palette, sizeof (ATLAS_PALETTE));
+	RtlCopyMemory ((PUCHAR)buffer + header->pixels_offset, source->pixels, header->pixels_size);
+
+	return TRUE;
+}
+
+BOOLEAN AtlasLoadBlob (
+	_In_reads_bytes_ (size) CONST VOID *buffer,
+	_In_ SIZE_T size,
+	_Out_ PATLAS_SOURCE source
+)
+{
+	CONST ATLAS_BLOB_HEADER *header;
+
+	RtlZeroMemory (source, sizeof (ATLAS_SOURCE));
+
+	if (size < sizeof (ATLAS_BLOB_HEADER))
+		return FALSE;
+
+	header = buffer;
+
+	if (header->magic != ATLAS_BLOB_MAGIC || header->version != ATLAS_BLOB_VERSION)
+		return FALSE;
+
+	// a damaged header must not make us read past the buffer
+	if (!header->width || !header->height || header->width > 0x10000 || header->height > 0x10000)
+		return FALSE;
+
+	if (header->pixels_size != (ULONG64)header->width * header->height || header->pixels_offset < sizeof (ATLAS_BLOB_HEADER))
+		return FALSE;
+
+	if ((SIZE_T)header->pixels_offset + header->pixels_size > size)
+		return FALSE;
+
+	// the sheet is only ever read, a resource section can be used as it is
+	source->pixels = (PUCHAR)buffer + header->pixels_offset;
+	source->width = header->width;
+	source->height = header->height;
+	source->scale = 1;
+
+	RtlCopyMemory (&source->palette, &header->palette, sizeof (ATLAS_PALETTE));
+
+	return TRUE;
+}
+
+BOOLEAN AtlasScaleSource (
+	_In_ PCATLAS_SOURCE source,
+	_In_ ULONG scale,
+	_Out_ PATLAS_SOURCE scaled
+)
+{
+	CONST UCHAR *src;
+	PUCHAR dest;
+	ULONG width;
+
+	RtlZeroMemory (scaled, sizeof (ATLAS_SOURCE));
+
+	if (!scale || scale > ATLAS_SCALE_MAX)
+		return FALSE;
+
+	width = source->width * scale;
+
+	scaled->pixels = malloc ((SIZE_T)width * source->height * scale);
+
+	if (!scaled->pixels)
+		return FALSE;
+
+	scaled->width = width;
+	scaled->height = source->height * scale;
+	scaled->scale = source->scale * scale;
+	scaled->palette = source->palette;
+
+	for (ULONG y = 0; y < source->height; y++)
+	{
+		src = source->pixels + ((SIZE_T)y * source->width);
+		dest = scaled->pixels + ((SIZE_T)y * scale * width);
+
+		for (ULONG x = 0; x < source->width; x++)
+			RtlFillMemory (dest + ((SIZE_T)x * scale), scale, src[x]);
+
+		// the other rows of the block are the same
+		for (ULONG i = 1; i < scale; i++)
+			RtlCopyMemory (dest + ((SIZE_T)i * width), dest, width);
+	}
+
+	return TRUE;
+}
+
+VOID AtlasFreeScaledSource (
+	_Inout_ PATLAS_SOURCE scaled
+)
+{
+	if (scaled->pixels)
+		free (scaled->pixels);
+
+	RtlZeroMemory (scaled, sizeof (ATLAS_SOURCE));
+}
+
+VOID AtlasCacheInitialize (
+	_Out_ PATLAS_CACHE cache,
+	_In_ PCATLAS_SOURCE source
+)
+{
+	RtlZeroMemory (cache, sizeof (ATLAS_CACHE));
+
+	cache->source = source;
+}
+
+PCATLAS_IMAGE AtlasCacheGet (
+	_Inout_ PATLAS_CACHE cache,
+	_In_ LONG hue
+)
+{
+	PCATLAS_SOURCE source;
+	PATLAS_IMAGE image;
+	SIZE_T length;
+
+	// hues above the period produce the same colours as hue - period,
+	// so fold them together to share the cached image
+	hue %= ATLAS_HUE_PERIOD;
+
+	image = &cache->image[hue];
+
+	if (image->pixels)
+	{
+		cache->hits += 1;
+
+		return image;
+	}
+
+	cache->misses += 1;
+
+	source = cache->source;
+
+	length = (SIZE_T)source->width * source->height;
+
+	image->pixels = PlatformAllocateAligned (length * sizeof (ULONG), 64);
+
+	if (!image->pixels)
+		return NULL;
+
+	image->width = source->width;
+	image->height = source->height;
+	image->scale = source->scale;
+	image->hue = hue;
+
+	AtlasRecolor (source, hue, image->pixels);
+
+	cache->count += 1;
+
+	return image;
+}
+
+VOID AtlasCacheReference (
+	_Inout_ PATLAS_CACHE cache,
+	_In_ PCATLAS_SOURCE source
+)
+{
+	if (!cache->references)
+		AtlasCacheInitialize (cache, source);
+
+	cache->references += 1;
+}
+
+BOOLEAN AtlasCacheDereference (
+	_Inout_ PATLAS_CACHE cache
+)
+{
+	if (!cache->references)
+		return FALSE;
+
+	cache->references -= 1;
+
+	if (cache->references)
+		return FALSE;
+
+	AtlasCacheDestroy (cache);
+
+	return TRUE;
+}
+
+VOID AtlasCacheDestroy (
+	_Inout_ PATLAS_CACHE cache
+)
+{
+	for (ULONG i = 0; i < RTL_NUMBER_OF (cache->image); i++)
+	{
+		if (cache->image[i].pixels)
+			PlatformFreeAligned (cache->image[i].pixels);
+	}
+
+	RtlZeroMemory (cache, sizeof (ATLAS_CACHE));
+}
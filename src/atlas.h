@@ -0,0 +1,190 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+#define ATLAS_PALETTE_SIZE 256
+#define ATLAS_SCALE_MAX 3 // largest integer upscale of the glyph sheet
+
+// hue, lightness and saturation ranges of ColorRGBToHLS/ColorHLSToRGB
+#define ATLAS_HLS_MAX 240
+#define ATLAS_HUE_PERIOD 240 // hue wraps after this value
+
+// prebaked glyph sheet, written by tools/atlasgen.c
+#define ATLAS_BLOB_MAGIC 0x534C5441 // "ATLS"
+#define ATLAS_BLOB_VERSION 1
+#define ATLAS_BLOB_ALIGNMENT 64
+
+// saturation and lightness of every palette entry, the hue is not
+// stored because recolouring replaces it anyway
+typedef struct _ATLAS_PALETTE
+{
+	USHORT saturation[ATLAS_PALETTE_SIZE];
+	USHORT lightness[ATLAS_PALETTE_SIZE];
+} ATLAS_PALETTE, *PATLAS_PALETTE;
+
+typedef CONST ATLAS_PALETTE *PCATLAS_PALETTE;
+
+// decoded 8-bit glyph sheet, rows are stored top-down
+typedef struct _ATLAS_SOURCE
+{
+	PUCHAR pixels;
+
+	ULONG width;
+	ULONG height;
+
+	// glyphs are scale times GLYPH_WIDTH by GLYPH_HEIGHT pixels
+	ULONG scale;
+
+	ATLAS_PALETTE palette;
+} ATLAS_SOURCE, *PATLAS_SOURCE;
+
+typedef CONST ATLAS_SOURCE *PCATLAS_SOURCE;
+
+//
+// blob layout, little endian: the header with the palette already split
+// into saturation and lightness, then the 8-bit sheet top-down at an
+// aligned offset. it is the source as it sits in memory, loading it
+// only checks the header and points at the pixels.
+//
+typedef struct _ATLAS_BLOB_HEADER
+{
+	ULONG magic;
+	ULONG version;
+
+	ULONG width;
+	ULONG height;
+
+	ULONG pixels_offset;
+	ULONG pixels_size;
+
+	ATLAS_PALETTE palette;
+} ATLAS_BLOB_HEADER, *PATLAS_BLOB_HEADER;
+
+// glyph sheet recoloured to one hue, 32 bits per pixel, top-down
+typedef struct _ATLAS_IMAGE
+{
+	PULONG pixels;
+
+	ULONG width;
+	ULONG height;
+	ULONG scale;
+
+	LONG hue;
+} ATLAS_IMAGE, *PATLAS_IMAGE;
+
+typedef CONST ATLAS_IMAGE *PCATLAS_IMAGE;
+
+//
+// one image for every hue of the period, built the first time its hue is
+// used and kept until the cache is destroyed. smooth colours walk through
+// every hue, anything smaller would be evicted before its reuse. one
+// cache is shared by every window of the process, each window holds a
+// reference on it.
+//
+typedef struct _ATLAS_CACHE
+{
+	PCATLAS_SOURCE source;
+
+	ATLAS_IMAGE image[ATLAS_HUE_PERIOD];
+
+	ULONG references;
+
+	ULONG count;
+	ULONG hits;
+	ULONG misses;
+} ATLAS_CACHE, *PATLAS_CACHE;
+
+VOID AtlasRGBToHLS (
+	_In_ COLORREF clr,
+	_Out_ PUSHORT hue,
+	_Out_ PUSHORT lightness,
+	_Out_ PUSHORT saturation
+);
+
+COLORREF AtlasHLSToRGB (
+	_In_ USHORT hue,
+	_In_ USHORT lightness,
+	_In_ USHORT saturation
+);
+
+VOID AtlasInitializePalette (
+	_Out_ PATLAS_PALETTE palette,
+	_In_reads_ (count) CONST COLORREF *colors,
+	_In_ ULONG count
+);
+
+VOID AtlasRecolorPalette (
+	_In_ PCATLAS_PALETTE palette,
+	_In_ LONG hue,
+	_Out_writes_ (ATLAS_PALETTE_SIZE) PULONG lut
+);
+
+VOID AtlasExpandPixels (
+	_In_reads_ (count) CONST UCHAR *src,
+	_In_reads_ (ATLAS_PALETTE_SIZE) CONST ULONG *lut,
+	_Out_writes_ (count) PULONG dest,
+	_In_ SIZE_T count
+);
+
+VOID AtlasRecolor (
+	_In_ PCATLAS_SOURCE source,
+	_In_ LONG hue,
+	_Out_writes_ (source->width * source->height) PULONG dest
+);
+
+SIZE_T AtlasGetBlobSize (
+	_In_ PCATLAS_SOURCE source
+);
+
+BOOLEAN AtlasSaveBlob (
+	_In_ PCATLAS_SOURCE source,
+	_Out_writes_bytes_ (size) PVOID buffer,
+	_In_ SIZE_T size
+);
+
+// pixels of the source point into the blob, it has to outlive the source
+BOOLEAN AtlasLoadBlob (
+	_In_reads_bytes_ (size) CONST VOID *buffer,
+	_In_ SIZE_T size,
+	_Out_ PATLAS_SOURCE source
+);
+
+// nearest neighbour upscale, palette indices stay exact so every hue recolours the same
+BOOLEAN AtlasScaleSource (
+	_In_ PCATLAS_SOURCE source,
+	_In_ ULONG scale,
+	_Out_ PATLAS_SOURCE scaled
+);
+
+VOID AtlasFreeScaledSource (
+	_Inout_ PATLAS_SOURCE scaled
+);
+
+VOID AtlasCacheInitialize (
+	_Out_ PATLAS_CACHE cache,
+	_In_ PCATLAS_SOURCE source
+);
+
+// returned image stays valid until the cache is destroyed
+PCATLAS_IMAGE AtlasCacheGet (
+	_Inout_ PATLAS_CACHE cache,
+	_In_ LONG hue
+);
+
+// first reference initializes the cache
+VOID AtlasCacheReference (
+	_Inout_ PATLAS_CACHE cache,
+	_In_ PCATLAS_SOURCE source
+);
+
+// last reference destroys the cache, returns TRUE then
+BOOLEAN AtlasCacheDereference (
+	_Inout_ PATLAS_CACHE cache
+);
+
+VOID AtlasCacheDestroy (
+	_Inout_ PATLAS_CACHE cache
+);
@@ -0,0 +1,217 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include "display.h"
+
+static VOID DisplayThreadProc (
+	_In_opt_ PVOID context
+)
+{
+	PDISPLAY_COORDINATOR coordinator;
+	PDISPLAY display;
+	ULONG steps;
+
+	display = context;
+	coordinator = display->coordinator;
+
+	PlatformAcquireLock (&coordinator->lock);
+
+	while (!coordinator->is_shutdown && !display->is_stopped)
+	{
+		steps = AdvanceScheduler (&display->scheduler);
+
+		if (steps)
+		{
+			PlatformReleaseLock (&coordinator->lock);
+
+			display->routine (display->context, steps);
+
+			PlatformAcquireLock (&coordinator->lock);
+
+			display->frames += 1;
+
+			continue;
+		}
+
+		// sleep until the next step is due or somebody stops us
+		PlatformWaitConditionTimeout (&coordinator->condition, &coordinator->lock, GetSchedulerDelay (&display->scheduler));
+	}
+
+	PlatformReleaseLock (&coordinator->lock);
+}
+
+VOID InitializeCoordinator (
+	_Out_ PDISPLAY_COORDINATOR coordinator
+)
+{
+	RtlZeroMemory (coordinator, sizeof (DISPLAY_COORDINATOR));
+
+	PlatformInitializeLock (&coordinator->lock);
+	PlatformInitializeCondition (&coordinator->condition);
+}
+
+VOID DeleteCoordinator (
+	_Inout_ PDISPLAY_COORDINATOR coordinator
+)
+{
+	RequestCoordinatorShutdown (coordinator);
+
+	while (TRUE)
+	{
+		PlatformAcquireLock (&coordinator->lock);
+
+		if (!coordinator->count)
+		{
+			PlatformReleaseLock (&coordinator->lock);
+
+			break;
+		}
+
+		PlatformReleaseLock (&coordinator->lock);
+
+		StopDisplay (coordinator->display[0]);
+	}
+
+	PlatformDeleteCondition (&coordinator->condition);
+	PlatformDeleteLock (&coordinator->lock);
+}
+
+BOOLEAN StartDisplay (
+	_Inout_ PDISPLAY_COORDINATOR coordinator,
+	_Inout_ PDISPLAY display,
+	_In_ PDISPLAY_FRAME_ROUTINE routine,
+	_In_opt_ PVOID context
+)
+{
+	BOOLEAN is_started = FALSE;
+
+	display->coordinator = coordinator;
+	display->routine = routine;
+	display->context = context;
+	display->frames = 0;
+	display->is_stopped = FALSE;
+
+	PlatformAcquireLock (&coordinator->lock);
+
+	if (!coordinator->is_shutdown && coordinator->count < RTL_NUMBER_OF (coordinator->display))
+	{
+		if (PlatformCreateThread (&display->thread, &DisplayThreadProc, display))
+		{
+			coordinator->display[coordinator->count++] = display;
+
+			is_started = TRUE;
+		}
+	}
+
+	PlatformReleaseLock (&coordinator->lock);
+
+	if (!is_started)
+		display->coordinator = NULL;
+
+	return is_started;
+}
+
+VOID StopDisplay (
+	_Inout_ PDISPLAY display
+)
+{
+	PDISPLAY_COORDINATOR coordinator;
+
+	coordinator = display->coordinator;
+
+	// never started or already stopped
+	if (!coordinator)
+		return;
+
+	PlatformAcquireLock (&coordinator->lock);
+
+	display->is_stopped = TRUE;
+
+	for (ULONG i = 0; i < coordinator->count; i++)
+	{
+		if (coordinator->display[i] == display)
+		{
+			coordinator->display[i] = coordinator->display[--coordinator->count];
+
+			break;
+		}
+	}
+
+	PlatformWakeAllCondition (&coordinator->condition);
+	PlatformReleaseLock (&coordinator->lock);
+
+	PlatformJoinThread (display->thread);
+
+	display->coordinator = NULL;
+}
+
+VOID RequestStopDisplay (
+	_Inout_ PDISPLAY display
+)
+{
+	PDISPLAY_COORDINATOR coordinator;
+
+	coordinator = display->coordinator;
+
+	if (!coordinator)
+		return;
+
+	PlatformAcquireLock (&coordinator->lock);
+
+	display->is_stopped = TRUE;
+
+	PlatformWakeAllCondition (&coordinator->condition);
+	PlatformReleaseLock (&coordinator->lock);
+}
+
+VOID SetDisplayStep (
+	_Inout_ PDISPLAY display,
+	_In_ ULONG64 step
+)
+{
+	PDISPLAY_COORDINATOR coordinator;
+
+	coordinator = display->coordinator;
+
+	// no thread, the scheduler belongs to the caller
+	if (!coordinator)
+	{
+		SetSchedulerStep (&display->scheduler, step);
+
+		return;
+	}
+
+	PlatformAcquireLock (&coordinator->lock);
+
+	SetSchedulerStep (&display->scheduler, step);
+
+	PlatformWakeAllCondition (&coordinator->condition);
+	PlatformReleaseLock (&coordinator->lock);
+}
+
+VOID RequestCoordinatorShutdown (
+	_Inout_ PDISPLAY_COORDINATOR coordinator
+)
+{
+	PlatformAcquireLock (&coordinator->lock);
+
+	coordinator->is_shutdown = TRUE;
+
+	PlatformWakeAllCondition (&coordinator->condition);
+	PlatformReleaseLock (&coordinator->lock);
+}
+
+BOOLEAN IsCoordinatorShutdown (
+	_Inout_ PDISPLAY_COORDINATOR coordinator
+)
+{
+	BOOLEAN is_shutdown;
+
+	PlatformAcquireLock (&coordinator->lock);
+
+	is_shutdown = coordinator->is_shutdown;
+
+	PlatformReleaseLock (&coordinator->lock);
+
+	return is_shutdown;
+}
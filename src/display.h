@@ -0,0 +1,92 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+#include "scheduler.h"
+
+#define DISPLAY_MAX 16 // displays driven by one coordinator
+
+// simulates the steps that are due, then renders and presents one frame
+typedef VOID (*PDISPLAY_FRAME_ROUTINE) (
+	_In_opt_ PVOID context,
+	_In_ ULONG steps
+);
+
+//
+// every display runs its simulation and presentation on its own thread
+// with its own scheduler, so a slow present on one monitor does not
+// delay the others. the coordinator only wakes and joins them.
+//
+typedef struct _DISPLAY
+{
+	struct _DISPLAY_COORDINATOR *coordinator;
+
+	PDISPLAY_FRAME_ROUTINE routine;
+	PVOID context;
+
+	SCHEDULER scheduler;
+
+	PLATFORM_THREAD thread;
+
+	ULONG64 frames;
+
+	BOOLEAN is_stopped;
+} DISPLAY, *PDISPLAY;
+
+typedef struct _DISPLAY_COORDINATOR
+{
+	PLATFORM_LOCK lock;
+	PLATFORM_CONDITION condition;
+
+	PDISPLAY display[DISPLAY_MAX];
+	ULONG count;
+
+	BOOLEAN is_shutdown;
+} DISPLAY_COORDINATOR, *PDISPLAY_COORDINATOR;
+
+VOID InitializeCoordinator (
+	_Out_ PDISPLAY_COORDINATOR coordinator
+);
+
+// stops and joins every display still running
+VOID DeleteCoordinator (
+	_Inout_ PDISPLAY_COORDINATOR coordinator
+);
+
+// scheduler is initialized by the caller, the thread owns it from here
+BOOLEAN StartDisplay (
+	_Inout_ PDISPLAY_COORDINATOR coordinator,
+	_Inout_ PDISPLAY display,
+	_In_ PDISPLAY_FRAME_ROUTINE routine,
+	_In_opt_ PVOID context
+);
+
+// returns once the display thread has finished its last frame
+VOID StopDisplay (
+	_Inout_ PDISPLAY display
+);
+
+// does not wait, the display stops drawing on its next wakeup and
+// StopDisplay only has to join it. the other displays keep running.
+VOID RequestStopDisplay (
+	_Inout_ PDISPLAY display
+);
+
+// safe from any thread, a display that sleeps wakes up to the new step
+VOID SetDisplayStep (
+	_Inout_ PDISPLAY display,
+	_In_ ULONG64 step
+);
+
+// safe from any thread, the displays stop drawing on their next wakeup and
+// no display can be started after it
+VOID RequestCoordinatorShutdown (
+	_Inout_ PDISPLAY_COORDINATOR coordinator
+);
+
+BOOLEAN IsCoordinatorShutdown (
+	_Inout_ PDISPLAY_COORDINATOR coordinator
+);
@@ -0,0 +1,106 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include "governor.h"
+
+#define GOVERNOR_SMOOTHING 3 // each sample moves the average by 1/8
+
+VOID InitializeGovernor (
+	_Out_ PGOVERNOR governor,
+	_In_ ULONG64 budget,
+	_In_ ULONG max_level
+)
+{
+	RtlZeroMemory (governor, sizeof (GOVERNOR));
+
+	governor->budget = budget ? budget : 1;
+	governor->max_level = (max_level < GOVERNOR_LEVEL_MAX) ? max_level : GOVERNOR_LEVEL_MAX;
+}
+
+VOID SetGovernorBudget (
+	_Inout_ PGOVERNOR governor,
+	_In_ ULONG64 budget
+)
+{
+	governor->budget = budget ? budget : 1;
+
+	governor->over = 0;
+	governor->under = 0;
+}
+
+static VOID SetGovernorLevel (
+	_Inout_ PGOVERNOR governor,
+	_In_ ULONG level
+)
+{
+	governor->level = level;
+	governor->changes += 1;
+
+	governor->over = 0;
+	governor->under = 0;
+
+	// the average belongs to the old level, start again from the next frame
+	governor->is_primed = FALSE;
+}
+
+BOOLEAN UpdateGovernor (
+	_Inout_ PGOVERNOR governor,
+	_In_ ULONG64 cost,
+	_In_ ULONG steps
+)
+{
+	ULONG64 sample;
+
+	if (!steps)
+		return FALSE;
+
+	sample = cost / steps;
+
+	if (governor->is_primed)
+	{
+		if (sample > governor->average)
+		{
+			governor->average += (sample - governor->average) >> GOVERNOR_SMOOTHING;
+		}
+		else
+		{
+			governor->average -= (governor->average - sample) >> GOVERNOR_SMOOTHING;
+		}
+	}
+	else
+	{
+		governor->average = sample;
+		governor->is_primed = TRUE;
+	}
+
+	if (governor->average > governor->budget)
+	{
+		governor->under = 0;
+
+		if (++governor->over >= GOVERNOR_DEGRADE_SAMPLES && governor->level < governor->max_level)
+		{
+			SetGovernorLevel (governor, governor->level + 1);
+
+			return TRUE;
+		}
+	}
+	else if (governor->average * 100 < governor->budget * GOVERNOR_RESTORE_PERCENT)
+	{
+		governor->over = 0;
+
+		if (++governor->under >= GOVERNOR_RESTORE_SAMPLES && governor->level)
+		{
+			SetGovernorLevel (governor, governor->level - 1);
+
+			return TRUE;
+		}
+	}
+	else
+	{
+		// inside the band, nothing to do
+		governor->over = 0;
+		governor->under = 0;
+	}
+
+	return FALSE;
+}
@@ -0,0 +1,61 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+#define GOVERNOR_LEVEL_MAX 3 // frames are drawn every 2^level steps at most
+
+#define GOVERNOR_DEGRADE_SAMPLES 8 // frames over budget before dropping a level
+#define GOVERNOR_RESTORE_SAMPLES 64 // frames with headroom before restoring one
+#define GOVERNOR_RESTORE_PERCENT 40 // headroom is less than this share of the budget
+
+//
+// frame time governor. the cost of every frame is spread over the steps
+// it covers and smoothed, the quality level goes up when that stays over
+// the budget and comes back when it stays well under it. each level halves
+// how often frames are drawn, so restoring one at most doubles the cost:
+// the restore threshold is kept under half the budget to never bounce.
+//
+typedef struct _GOVERNOR
+{
+	ULONG64 budget;
+	ULONG64 average;
+
+	ULONG64 changes;
+
+	ULONG level;
+	ULONG max_level;
+
+	ULONG over;
+	ULONG under;
+
+	BOOLEAN is_primed;
+} GOVERNOR, *PGOVERNOR;
+
+VOID InitializeGovernor (
+	_Out_ PGOVERNOR governor,
+	_In_ ULONG64 budget,
+	_In_ ULONG max_level
+);
+
+VOID SetGovernorBudget (
+	_Inout_ PGOVERNOR governor,
+	_In_ ULONG64 budget
+);
+
+// returns true when the level was changed
+BOOLEAN UpdateGovernor (
+	_Inout_ PGOVERNOR governor,
+	_In_ ULONG64 cost,
+	_In_ ULONG steps
+);
+
+// simulation steps per drawn frame
+FORCEINLINE ULONG GetGovernorStride (
+	_In_ PGOVERNOR governor
+)
+{
+	return 1UL << governor->level;
+}
@@ -10,6 +10,22 @@
 #include "resource.h"
 
 STATIC_DATA config = {0};
+// one glyph sheet and cache per render scale, 1x is the embedded atlas
+ATLAS_SOURCE atlas_source[ATLAS_SCALE_MAX] = {0};
+ATLAS_CACHE atlas_cache[ATLAS_SCALE_MAX] = {0};
+PLATFORM_LOCK atlas_lock;
+
+DISPLAY_COORDINATOR coordinator;
+
+// created on the window thread on first need, read by the display threads
+PWORKER_POOL volatile worker_pool = NULL;
+
+// every window that draws, only used on the window thread
+PMATRIX_VIEW view_list = NULL;
+
+// views merge into this on the window thread when they are destroyed
+STATS stats_total = {0};
+ULONG stats_id = 0;
 
 #define RND_MAX INT_MAX
 
@@ -19,8 +35,14 @@ VOID ReadSettings ()
 	config.amount = _r_config_getlong (L"NumGlyphs", AMOUNT_DEFAULT, NULL);
 	config.density = _r_config_getlong (L"Density", DENSITY_DEFAULT, NULL);
 	config.hue = _r_config_getlong (L"Hue", HUE_DEFAULT, NULL);
+	config.threads = _r_config_getlong (L"Threads", THREADS_DEFAULT, NULL);
+	config.render_scale = _r_config_getlong (L"RenderScale", RENDER_SCALE_DEFAULT, NULL);
+	config.cells_target = _r_config_getlong (L"CellsTarget", RENDER_CELLS_TARGET, NULL);
 
 	config.is_esc_only = _r_config_getboolean (L"IsEscOnly", FALSE, NULL);
+	config.is_adaptive = _r_config_getboolean (L"IsAdaptive", ADAPTIVE_DEFAULT, NULL);
+	config.is_stats = _r_config_getboolean (L"IsStats", FALSE, NULL);
+	config.is_trace = _r_config_getboolean (L"IsTrace", FALSE, NULL);
 
 	config.is_random = _r_config_getboolean (L"Random", HUE_RANDOM, NULL);
 	config.is_smooth = _r_config_getboolean (L"RandomSmoothTransition", HUE_RANDOM_SMOOTHTRANSITION, NULL);
@@ -32,464 +54,823 @@ VOID SaveSettings ()
 	_r_config_setlong (L"NumGlyphs", config.amount, NULL);
 	_r_config_setlong (L"Density", config.density, NULL);
 	_r_config_setlong (L"Hue", config.hue, NULL);
+	_r_config_setlong (L"Threads", config.threads, NULL);
+	_r_config_setlong (L"RenderScale", config.render_scale, NULL);
+	_r_config_setlong (L"CellsTarget", config.cells_target, NULL);
 
 	_r_config_setboolean (L"IsEscOnly", config.is_esc_only, NULL);
+	_r_config_setboolean (L"IsAdaptive", config.is_adaptive, NULL);
+	_r_config_setboolean (L"IsStats", config.is_stats, NULL);
+	_r_config_setboolean (L"IsTrace", config.is_trace, NULL);
 
 	_r_config_setboolean (L"Random", config.is_random, NULL);
 	_r_config_setboolean (L"RandomSmoothTransition", config.is_smooth, NULL);
 }
 
-FORCEINLINE COLORREF HSLtoRGB (
-	_In_ WORD h,
-	_In_ WORD s,
-	_In_ WORD l
+BOOLEAN LoadAtlasSource (
+	_In_ HINSTANCE hinst,
+	_Out_ PATLAS_SOURCE source
 )
 {
-	return ColorHLSToRGB (h, l, s);
+	HRSRC hresource;
+	HGLOBAL hdata;
+	PVOID data;
+	ULONG size;
+
+	// sheet and palette were baked at build time, the image section is used as it is
+	hresource = FindResourceW (hinst, MAKEINTRESOURCE (IDR_ATLAS), RT_RCDATA);
+
+	if (!hresource)
+		return FALSE;
+
+	size = SizeofResource (hinst, hresource);
+	hdata = LoadResource (hinst, hresource);
+
+	if (!hdata || !size)
+		return FALSE;
+
+	data = LockResource (hdata);
+
+	if (!data)
+		return FALSE;
+
+	return AtlasLoadBlob (data, size, source);
 }
 
-FORCEINLINE VOID RGBtoHSL (
-	_In_ COLORREF clr,
-	_Out_ PWORD h,
-	_Out_ PWORD s,
-	_Out_ PWORD l
+VOID FreeAtlasSource (
+	_Inout_ PATLAS_SOURCE source
 )
 {
-	ColorRGBToHLS (clr, h, l, s);
+	// pixels belong to the module image
+	RtlZeroMemory (source, sizeof (ATLAS_SOURCE));
 }
 
-FORCEINLINE GLYPH GlyphIntensity (
-	_In_ GLYPH glyph
+BOOLEAN GetSnapshotPath (
+	_Out_writes_ (length) LPWSTR buffer,
+	_In_ ULONG length,
+	_In_ LPCWSTR name,
+	_In_ BOOLEAN is_create
 )
 {
-	return ((glyph & 0x7F00) >> 8);
+	SIZE_T name_length;
+	ULONG chars;
+
+	chars = ExpandEnvironmentStringsW (SNAPSHOT_DIRECTORY, buffer, length);
+	name_length = wcslen (name);
+
+	if (!chars || chars + name_length + 1 > length)
+		return FALSE;
+
+	if (is_create && !CreateDirectoryW (buffer, NULL) && GetLastError () != ERROR_ALREADY_EXISTS)
+		return FALSE;
+
+	buffer[chars - 1] = L'\\';
+
+	RtlCopyMemory (buffer + chars, name, (name_length + 1) * sizeof (WCHAR));
+
+	return TRUE;
 }
 
-FORCEINLINE GLYPH RandomGlyph (
-	_In_ INT intensity
+PMATRIX LoadMatrixSnapshot (
+	_In_ ULONG numcols,
+	_In_ ULONG numrows
 )
 {
-	return GLYPH_REDRAW | (intensity << 8) | (_r_math_getrandomrange (0, RND_MAX) % config.amount);
+	WCHAR path[MAX_PATH];
+	LARGE_INTEGER size;
+	PMATRIX matrix = NULL;
+	HANDLE hfile;
+	HANDLE hmap;
+	PVOID view;
+
+	if (!GetSnapshotPath (path, RTL_NUMBER_OF (path), SNAPSHOT_NAME, FALSE))
+		return NULL;
+
+	hfile = CreateFileW (path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (hfile == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	if (GetFileSizeEx (hfile, &size) && size.QuadPart > 0 && (ULONG64)size.QuadPart <= SIZE_MAX)
+	{
+		hmap = CreateFileMappingW (hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+		if (hmap)
+		{
+			view = MapViewOfFile (hmap, FILE_MAP_READ, 0, 0, 0);
+
+			if (view)
+			{
+				matrix = RestoreMatrix (view, (SIZE_T)size.QuadPart, numcols, numrows);
+
+				UnmapViewOfFile (view);
+			}
+
+			CloseHandle (hmap);
+		}
+	}
+
+	CloseHandle (hfile);
+
+	return matrix;
 }
 
-FORCEINLINE GLYPH DarkenGlyph (
-	_In_ GLYPH glyph
+VOID SaveMatrixSnapshotFile (
+	_In_ PMATRIX matrix
 )
 {
-	GLYPH intensity;
+	WCHAR path[MAX_PATH];
+	WCHAR temp_path[MAX_PATH];
+	HANDLE hfile;
+	PVOID buffer;
+	SIZE_T size;
+	ULONG written = 0;
+	BOOLEAN is_written = FALSE;
+
+	if (!GetSnapshotPath (path, RTL_NUMBER_OF (path), SNAPSHOT_NAME, TRUE))
+		return;
+
+	if (!GetSnapshotPath (temp_path, RTL_NUMBER_OF (temp_path), SNAPSHOT_TEMP_NAME, FALSE))
+		return;
+
+	size = GetMatrixSnapshotSize (matrix);
+
+	if (size > MAXDWORD)
+		return;
+
+	buffer = _r_mem_allocate (size);
+
+	SaveMatrixSnapshot (matrix, buffer, size);
 
-	intensity = GlyphIntensity (glyph);
+	// write aside and swap, a crash must not leave half a snapshot
+	hfile = CreateFileW (temp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
 
-	if (intensity > 0)
-		return GLYPH_REDRAW | ((intensity - 1) << 8) | (glyph & 0x00FF);
+	if (hfile != INVALID_HANDLE_VALUE)
+	{
+		is_written = WriteFile (hfile, buffer, (ULONG)size, &written, NULL) && written == size;
+
+		CloseHandle (hfile);
+
+		if (is_written)
+		{
+			MoveFileExW (temp_path, path, MOVEFILE_REPLACE_EXISTING);
+		}
+		else
+		{
+			DeleteFileW (temp_path);
+		}
+	}
 
-	return glyph;
+	_r_mem_free (buffer);
 }
 
-FORCEINLINE VOID DrawGlyph (
-	_In_ PMATRIX matrix,
-	_In_ HDC hdc,
-	_In_ ULONG xpos,
-	_In_ ULONG ypos,
-	_In_ GLYPH glyph
+VOID StatsFileWriter (
+	_In_opt_ PVOID context,
+	_In_reads_ (length) PCSTR text,
+	_In_ SIZE_T length
 )
 {
-	GLYPH intensity;
-	ULONG glyph_idx;
-
-	intensity = GlyphIntensity (glyph);
-	glyph_idx = glyph & 0xFF;
-
-	BitBlt (
-		hdc,
-		xpos,
-		ypos,
-		GLYPH_WIDTH,
-		GLYPH_HEIGHT,
-		matrix->hdc,
-		glyph_idx * GLYPH_WIDTH,
-		intensity * GLYPH_HEIGHT,
-		SRCCOPY
-	);
+	PSTATS_FILE file;
+	ULONG written;
+
+	file = context;
+
+	if (file->length + length > sizeof (file->buffer))
+	{
+		WriteFile (file->hfile, file->buffer, file->length, &written, NULL);
+
+		file->length = 0;
+	}
+
+	// does not fit even in an empty buffer, write it straight through
+	if (length > sizeof (file->buffer))
+	{
+		WriteFile (file->hfile, text, (ULONG)length, &written, NULL);
+
+		return;
+	}
+
+	RtlCopyMemory (file->buffer + file->length, text, length);
+
+	file->length += (ULONG)length;
 }
 
-FORCEINLINE VOID RedrawBlip (
-	_Inout_ PGLYPH glyph_arr,
-	_In_ ULONG_PTR blip_pos
+VOID SaveStatsFile (
+	_In_ LPCWSTR name,
+	_In_ BOOLEAN is_trace
 )
 {
-	glyph_arr[blip_pos + 0] |= GLYPH_REDRAW;
-	glyph_arr[blip_pos + 1] |= GLYPH_REDRAW;
-	glyph_arr[blip_pos + 8] |= GLYPH_REDRAW;
-	glyph_arr[blip_pos + 9] |= GLYPH_REDRAW;
+	WCHAR path[MAX_PATH];
+	PSTATS_FILE file;
+	ULONG written;
+
+	if (!GetSnapshotPath (path, RTL_NUMBER_OF (path), name, TRUE))
+		return;
+
+	file = _r_mem_allocate (sizeof (STATS_FILE));
+
+	file->hfile = CreateFileW (path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (file->hfile != INVALID_HANDLE_VALUE)
+	{
+		if (is_trace)
+		{
+			WriteStatsTrace (&stats_total, &StatsFileWriter, file);
+		}
+		else
+		{
+			WriteStatsJson (&stats_total, &StatsFileWriter, file);
+		}
+
+		if (file->length)
+			WriteFile (file->hfile, file->buffer, file->length, &written, NULL);
+
+		CloseHandle (file->hfile);
+	}
+
+	_r_mem_free (file);
 }
 
-VOID ScrollMatrixColumn (
-	_Inout_ PMATRIX_COLUMN column
+VOID PresentMatrixView (
+	_In_ HWND hwnd,
+	_Inout_ PMATRIX_VIEW view
 )
 {
-	GLYPH last_glyph;
-	GLYPH current_glyph;
-	GLYPH current_glyph_intensity;
-	LONG density;
+	PFRAMEBUFFER framebuffer;
+	HDC hdc;
 
-	// wait until we are allowed to scroll
-	if (!column->is_started)
-	{
-		if (--column->countdown <= 0)
-			column->is_started = TRUE;
+	framebuffer = &view->framebuffer;
 
+	if (!IsFramebufferDirty (framebuffer))
 		return;
-	}
 
-	// "seed" the glyph-run
-	last_glyph = column->state ? 0 : (MAX_INTENSITY << 8);
+	hdc = GetDC (hwnd);
 
-	//
-	// loop over the entire length of the column, looking for changes
-	// in intensity/darkness. This change signifies the start/end
-	// of a run of glyphs.
-	//
-	for (ULONG_PTR y = 0; y < (ULONG_PTR)column->length; y++)
+	if (hdc)
 	{
-		current_glyph = column->glyph[y];
-
-		current_glyph_intensity = GlyphIntensity (current_glyph);
+		// one blit of the changed area per frame
+		BitBlt (
+			hdc,
+			framebuffer->left,
+			framebuffer->top,
+			framebuffer->right - framebuffer->left,
+			framebuffer->bottom - framebuffer->top,
+			view->hdc,
+			framebuffer->left,
+			framebuffer->top,
+			SRCCOPY
+		);
+
+		ReleaseDC (hwnd, hdc);
+	}
 
-		// bottom-most part of "run". Insert a new character (glyph)
-		// at the end to lengthen the run down the screen..gives the
-		// impression that the run is "falling" down the screen
-		if (current_glyph_intensity < GlyphIntensity (last_glyph) && current_glyph_intensity == 0)
-		{
-			column->glyph[y] = RandomGlyph (MAX_INTENSITY - 1);
+	ResetFramebufferDirty (framebuffer);
+}
 
-			y += 1;
-		}
+FORCEINLINE ULONG GetStepInterval ()
+{
+	return ((SPEED_MAX - config.speed) + SPEED_MIN) * 10;
+}
 
-		// top-most part of "run". Delete a character off the top by
-		// darkening the glyph until it eventually disappears (turns black). 
-		// this gives the effect that the run has dropped downwards
-		else if (current_glyph_intensity > GlyphIntensity (last_glyph))
-		{
-			column->glyph[y] = DarkenGlyph (current_glyph);
+FORCEINLINE ULONG64 GetFrameBudget ()
+{
+	return GetStepInterval () * 10000ULL * ADAPTIVE_BUDGET_PERCENT;
+}
 
-			// if we've just darkened the last bit, skip on so
-			// the whole run doesn't go dark
-			if (current_glyph_intensity == MAX_INTENSITY - 1)
-				y++;
-		}
+VOID StepMatrixView (
+	_Inout_ PMATRIX_VIEW view
+)
+{
+	// settings could be changed from the settings window at any time
+	view->matrix->amount = config.amount;
+	view->matrix->density = config.density;
 
-		if (y < column->length)
-			last_glyph = column->glyph[y];
-	}
+	UpdateMatrixParallel (view->matrix, PlatformLoadPointerAcquire ((PVOID volatile *)&worker_pool));
 
-	// change state from blanks <-> runs when the current run has expired
-	if (--column->run_length <= 0)
+	if (config.is_random)
 	{
-		density = DENSITY_MAX - config.density + DENSITY_MIN;
-
-		if (column->state ^= 1)
+		if (config.is_smooth)
 		{
-			column->run_length = _r_math_getrandomrange (0, RND_MAX) % (3 * density / 2) + DENSITY_MIN;
+			view->hue = (view->hue >= HUE_MAX) ? HUE_MIN : view->hue + 1;
 		}
 		else
 		{
-			column->run_length = _r_math_getrandomrange (0, RND_MAX) % (DENSITY_MAX + 1 - density) + (DENSITY_MIN * 2);
+			if (_r_sys_gettickcount () % 2)
+				view->hue = _r_math_getrandomrange (HUE_MIN, HUE_MAX);
 		}
 	}
+	else
+	{
+		view->hue = config.hue;
+	}
+}
 
-	// mark current blip as redraw so it gets "erased"
-	if (column->blip_pos >= 0 && column->blip_pos < column->length)
-		RedrawBlip (column->glyph, column->blip_pos);
-
-	// advance down screen at double-speed
-	column->blip_pos += 2;
-
-	// if the blip gets to the end of a run, start it again (for a random
-	// length so that the blips never get synched together)
-	if (column->blip_pos >= column->blip_length)
+// atlas_lock is held, the 1x sheet is loaded
+BOOLEAN ReferenceAtlasScale (
+	_In_ ULONG scale
+)
+{
+	// larger sheets are scaled once from the embedded one, while some window uses them
+	if (!atlas_source[scale - 1].pixels)
 	{
-		column->blip_length = column->length + (_r_math_getrandomrange (0, RND_MAX) % 50);
-		column->blip_pos = 0;
+		if (!AtlasScaleSource (&atlas_source[0], scale, &atlas_source[scale - 1]))
+			return FALSE;
 	}
 
-	// now redraw blip at new position
-	if (column->blip_pos >= 0 && column->blip_pos < column->length)
-		RedrawBlip (column->glyph, column->blip_pos);
+	AtlasCacheReference (&atlas_cache[scale - 1], &atlas_source[scale - 1]);
+
+	return TRUE;
 }
 
-//
-// randomly change a small collection glyphs in a column
-//
-VOID RandomMatrixColumn (
-	_Inout_ PMATRIX_COLUMN column
+// atlas_lock is held
+VOID DereferenceAtlasScale (
+	_In_ ULONG scale
 )
 {
-	ULONG rand;
+	// last window at this scale gone, nothing will draw these glyphs anymore
+	if (AtlasCacheDereference (&atlas_cache[scale - 1]) && scale > 1)
+		AtlasFreeScaledSource (&atlas_source[scale - 1]);
+}
 
-	for (ULONG_PTR i = 1, y = 0; i < 16; i++)
-	{
-		// find a run
-		while (y < column->length && GlyphIntensity (column->glyph[y]) < (MAX_INTENSITY - 1))
-			y += 1;
+ULONG GetMatrixViewScale (
+	_In_ ULONG width,
+	_In_ ULONG height,
+	_In_ ULONG dpi
+)
+{
+	if (config.render_scale > 0)
+		return (ULONG)min (config.render_scale, ATLAS_SCALE_MAX);
 
-		if (y >= column->length)
-			break;
+	return GetRenderScale (width, height, dpi, (ULONG)max (config.cells_target, 0));
+}
 
-		rand = _r_math_getrandomrange (0, RND_MAX);
+VOID UpdateMatrixViewAtlas (
+	_Inout_ PMATRIX_VIEW view
+)
+{
+	PATLAS_CACHE cache;
+	ULONG misses;
 
-		column->glyph[y] = (column->glyph[y] & 0xFF00) | (rand % config.amount);
-		column->glyph[y] |= GLYPH_REDRAW;
+	cache = &atlas_cache[view->scale - 1];
 
-		y += rand % 10;
-	}
+	PlatformAcquireLock (&atlas_lock);
+
+	misses = cache->misses;
+
+	view->atlas = AtlasCacheGet (cache, view->hue);
+
+	AddStatsCounter (&view->stats, StatsAtlasBuilds, cache->misses - misses);
+
+	PlatformReleaseLock (&atlas_lock);
 }
 
-VOID RedrawMatrixColumn (
-	_Inout_ PMATRIX_COLUMN column,
-	_In_ PMATRIX matrix,
-	_In_ HDC hdc,
-	_In_ ULONG xpos
+// runs on the display thread of the view
+VOID DecodeMatrix (
+	_In_opt_ PVOID context,
+	_In_ ULONG steps
 )
 {
-	GLYPH glyph;
+	PMATRIX_VIEW view;
+	ULONG64 start;
+	ULONG64 phase;
+	ULONG64 now;
+	ULONG stride;
+
+	view = context;
+
+	// a resize from the window thread swaps the grid and the frame buffer
+	PlatformAcquireLock (&view->lock);
+
+	start = PlatformQueryNanoseconds ();
+
+	// what the scheduler kept after paying out steps is how late this wake up is
+	RecordStatsValue (&view->stats, StatsTickJitter, view->display.scheduler.accumulator);
+
+	for (ULONG i = 0; i < steps; i++)
+		StepMatrixView (view);
+
+	now = PlatformQueryNanoseconds ();
+
+	RecordStatsPhase (&view->stats, StatsSimulate, start, now);
+
+	AddStatsCounter (&view->stats, StatsSteps, steps);
+	AddStatsCounter (&view->stats, StatsCellsStepped, (ULONG64)steps * view->matrix->numcols * view->matrix->numrows);
+
+	view->pending_steps += steps;
+
+	stride = config.is_adaptive ? GetGovernorStride (&view->governor) : 1;
+
+	// too slow to draw every step, the rain keeps its speed with fewer frames
+	if (view->pending_steps < stride)
+	{
+		view->pending_cost += now - start;
+
+		PlatformReleaseLock (&view->lock);
+
+		return;
+	}
+
+	// windows on the same hue draw from the same shared image
+	if (!view->atlas || view->atlas->hue != view->hue % ATLAS_HUE_PERIOD)
+	{
+		phase = now;
+
+		UpdateMatrixViewAtlas (view);
+
+		now = PlatformQueryNanoseconds ();
 
-	// loop down the length of the column redrawing only what needs doing
-	for (ULONG_PTR i = 0; i < column->length; i++)
+		RecordStatsPhase (&view->stats, StatsAtlas, phase, now);
+	}
+
+	if (view->atlas)
 	{
-		glyph = column->glyph[i];
+		phase = now;
+
+		// gdi could still be reading the frame from the previous present
+		GdiFlush ();
 
-		// does this glyph (character) need to be redrawn?
-		if (glyph & GLYPH_REDRAW)
+		AddStatsCounter (&view->stats, StatsCellsRedrawn, RenderMatrix (view->matrix, &view->framebuffer, view->atlas, view->kernel));
+
+		now = PlatformQueryNanoseconds ();
+
+		RecordStatsPhase (&view->stats, StatsRender, phase, now);
+
+		if (IsFramebufferDirty (&view->framebuffer))
 		{
-			if ((GlyphIntensity (glyph) >= MAX_INTENSITY - 1) && (i == column->blip_pos + 0 || i == column->blip_pos + 1 || i == column->blip_pos + 8 || i == column->blip_pos + 9))
-				glyph |= MAX_INTENSITY << 8;
+			phase = now;
+
+			PresentMatrixView (view->hwnd, view);
+
+			now = PlatformQueryNanoseconds ();
 
-			DrawGlyph (matrix, hdc, xpos, (ULONG)i * GLYPH_HEIGHT, glyph);
+			RecordStatsPhase (&view->stats, StatsPresent, phase, now);
 
-			// clear redraw state
-			column->glyph[i] &= ~GLYPH_REDRAW;
+			AddStatsCounter (&view->stats, StatsPresents, 1);
 		}
 	}
-}
 
-HBITMAP MakeBitmap (
-	_In_ HDC hdc,
-	_In_ HINSTANCE hinst,
-	_In_ UINT type,
-	_In_ LONG hue
-)
-{
-	RGBQUAD pal[256] = {0};
-	DIBSECTION dib = {0};
-	LPBITMAPINFOHEADER lpbih;
-	PULONG dest = NULL;
-	PBYTE src;
-	HDC hdc_c;
-	HBITMAP hglyph;
-	HBITMAP hdib;
-	HANDLE hbitmap_old;
-	RGBQUAD rgb;
-	COLORREF clr;
-	WORD h, s, l;
+	RecordStatsPhase (&view->stats, StatsFrame, start, now);
 
-	// load the 8bit image
-	hglyph = LoadImageW (hinst, MAKEINTRESOURCE (IDR_GLYPH), IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION);
+	AddStatsCounter (&view->stats, StatsFrames, 1);
 
-	// extract the colour table
-	hdc_c = CreateCompatibleDC (hdc);
-	hbitmap_old = SelectObject (hdc_c, hglyph);
+	view->pending_cost += now - start;
 
-	GetDIBColorTable (hdc_c, 0, RTL_NUMBER_OF (pal), pal);
-	SelectObject (hdc_c, hbitmap_old);
+	if (config.is_adaptive)
+		UpdateGovernor (&view->governor, view->pending_cost, view->pending_steps);
 
-	GetObjectW (hglyph, sizeof (dib), &dib);
+	view->pending_cost = 0;
+	view->pending_steps = 0;
 
-	src = dib.dsBm.bmBits;
-	lpbih = &dib.dsBmih;
+	PlatformReleaseLock (&view->lock);
+}
 
-	// change to a 32bit bitmap
-	dib.dsBm.bmBitsPixel = 32;
-	dib.dsBm.bmPlanes = 1;
-	dib.dsBm.bmWidthBytes = dib.dsBm.bmWidth * 4;
-	dib.dsBmih.biBitCount = 32;
-	dib.dsBmih.biPlanes = 1;
-	dib.dsBmih.biCompression = BI_RGB;
-	dib.dsBmih.biSizeImage = (dib.dsBmih.biWidth * dib.dsBmih.biHeight) * 4;
+// window thread only, it is the one that writes the pointer
+VOID PrepareWorkerPool (
+	_In_ PMATRIX matrix
+)
+{
+	PWORKER_POOL pool;
 
-	// create a new (blank) 32bit DIB section
-	hdib = CreateDIBSection (hdc_c, (LPBITMAPINFO)&dib.dsBmih, DIB_RGB_COLORS, &dest, 0, 0);
+	// workers only pay off on wide grids, previews stay on this thread
+	if (worker_pool || config.threads == 1 || matrix->numcols < MATRIX_PARALLEL_COLUMNS)
+		return;
 
-	// copy each pixel
-	for (LONG i = 0; i < lpbih->biWidth * lpbih->biHeight; i++)
-	{
-		// convert 8bit palette entry to 32bit colour
-		rgb = pal[*src++];
-		clr = RGB (rgb.rgbRed, rgb.rgbGreen, rgb.rgbBlue);
+	pool = CreateWorkerPool ((ULONG)config.threads);
 
-		// convert the RGB colour to H,S,L values
-		RGBtoHSL (clr, &h, &s, &l);
+	// display threads already running pick it up with their next step
+	PlatformStorePointerRelease ((PVOID volatile *)&worker_pool, pool);
+}
 
-		// create the new colour
-		*dest++ = HSLtoRGB ((WORD)hue, s, l);
+VOID DestroyMatrixViewBitmap (
+	_Inout_ PMATRIX_VIEW view
+)
+{
+	if (view->hdc)
+	{
+		SelectObject (view->hdc, view->hbitmap_old);
+		DeleteDC (view->hdc);
+
+		view->hdc = NULL;
 	}
 
-	DeleteObject (hglyph);
-	DeleteDC (hdc_c);
+	if (view->hbitmap)
+	{
+		DeleteObject (view->hbitmap);
 
-	return hdib;
+		view->hbitmap = NULL;
+	}
+
+	// nothing to draw into, but keep the window alive
+	InitializeFramebuffer (&view->framebuffer, NULL, 0, 0, 0);
 }
 
-VOID SetMatrixBitmap (
-	_In_ HDC hdc,
-	_Inout_ PMATRIX matrix,
-	_In_ INT hue
+VOID CreateMatrixViewBitmap (
+	_Inout_ PMATRIX_VIEW view,
+	_In_ ULONG width,
+	_In_ ULONG height
 )
 {
+	BITMAPINFO bmi = {0};
 	HBITMAP hbitmap;
-	HBITMAP hbitmap_old;
+	PVOID pixels = NULL;
 
-	hbitmap = MakeBitmap (hdc, _r_sys_getimagebase (), IDR_GLYPH, hue);
+	// top-down 32bit frame buffer
+	bmi.bmiHeader.biSize = sizeof (BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = width;
+	bmi.bmiHeader.biHeight = -(LONG)height;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	hbitmap = CreateDIBSection (NULL, &bmi, DIB_RGB_COLORS, &pixels, NULL, 0);
 
 	if (!hbitmap)
+	{
+		DestroyMatrixViewBitmap (view);
 		return;
+	}
 
-	hbitmap_old = SelectObject (matrix->hdc, hbitmap);
+	if (view->hdc)
+	{
+		SelectObject (view->hdc, hbitmap);
+	}
+	else
+	{
+		view->hdc = CreateCompatibleDC (NULL);
+		view->hbitmap_old = SelectObject (view->hdc, hbitmap);
+	}
 
-	if (hbitmap_old)
-		DeleteObject (hbitmap_old);
+	if (view->hbitmap)
+		DeleteObject (view->hbitmap);
 
-	matrix->hbitmap = hbitmap;
+	view->hbitmap = hbitmap;
 
-	SelectObject (matrix->hdc, matrix->hbitmap);
+	InitializeFramebuffer (&view->framebuffer, pixels, width, height, width);
 }
 
-VOID DecodeMatrix (
+PMATRIX_VIEW CreateMatrixView (
 	_In_ HWND hwnd,
-	_In_ PMATRIX matrix
+	_In_ ULONG width,
+	_In_ ULONG height
 )
 {
-	static LONG new_hue = 0;
+	PMATRIX_VIEW view;
+	PMATRIX matrix;
+	ULONG scale;
+	BOOLEAN is_referenced;
 
-	PMATRIX_COLUMN column;
-	HDC hdc;
+	if (!atlas_source[0].pixels)
+	{
+		if (!LoadAtlasSource (_r_sys_getimagebase (), &atlas_source[0]))
+			return NULL;
+	}
 
-	hdc = GetDC (hwnd);
+	// the first window at a scale builds its shared atlas, the others only take it
+	scale = GetMatrixViewScale (width, height, _r_dc_getwindowdpi (hwnd));
 
-	if (!hdc)
-		return;
+	PlatformAcquireLock (&atlas_lock);
 
-	if (!new_hue)
-		new_hue = config.hue;
+	is_referenced = ReferenceAtlasScale (scale);
 
-	for (ULONG_PTR x = 0; x < matrix->numcols; x++)
+	if (!is_referenced && scale > 1)
 	{
-		column = &matrix->column[x];
-
-		RandomMatrixColumn (column);
-		ScrollMatrixColumn (column);
-		RedrawMatrixColumn (column, matrix, hdc, (ULONG)x * GLYPH_WIDTH);
+		scale = 1;
+		is_referenced = ReferenceAtlasScale (scale);
 	}
 
-	if (config.is_random)
+	PlatformReleaseLock (&atlas_lock);
+
+	if (!is_referenced)
+		return NULL;
+
+	// continue the rain from the last run, a fresh seed keeps monitors apart
+	matrix = LoadMatrixSnapshot (GetRenderColumns (width, scale), GetRenderRows (height, scale));
+
+	if (matrix)
 	{
-		if (config.is_smooth)
-		{
-			new_hue = (new_hue >= HUE_MAX) ? HUE_MIN : new_hue + 1;
-		}
-		else
-		{
-			if (_r_sys_gettickcount () % 2)
-				new_hue = _r_math_getrandomrange (HUE_MIN, HUE_MAX);
-		}
+		ReseedMatrix (matrix, _r_math_getrandomrange (0, RND_MAX));
 	}
 	else
 	{
-		new_hue = config.hue;
+		matrix = CreateMatrix (GetRenderColumns (width, scale), GetRenderRows (height, scale), _r_math_getrandomrange (0, RND_MAX));
+
+		if (!matrix)
+		{
+			PlatformAcquireLock (&atlas_lock);
+			DereferenceAtlasScale (scale);
+			PlatformReleaseLock (&atlas_lock);
+
+			return NULL;
+		}
 	}
 
-	SetMatrixBitmap (hdc, matrix, new_hue);
+	PrepareWorkerPool (matrix);
+
+	view = _r_mem_allocate (sizeof (MATRIX_VIEW));
 
-	ReleaseDC (hwnd, hdc);
+	view->hwnd = hwnd;
+	view->matrix = matrix;
+	view->width = width;
+	view->height = height;
+	view->scale = scale;
+	view->kernel = GetRenderKernel (scale);
+	view->hue = config.hue;
+
+	PlatformInitializeLock (&view->lock);
+
+	// the trace ring is the only part that can fail, counters work without it
+	if (!InitializeStats (&view->stats, ++stats_id, config.is_trace ? STATS_TRACE_EVENTS : 0))
+		InitializeStats (&view->stats, stats_id, 0);
+
+	UpdateMatrixViewAtlas (view);
+
+	InitializeScheduler (&view->display.scheduler, GetStepInterval () * 1000000ULL, STEPS_MAX, NULL, NULL);
+	InitializeGovernor (&view->governor, GetFrameBudget (), GOVERNOR_LEVEL_MAX);
+
+	CreateMatrixViewBitmap (view, width, height);
+
+	view->next = view_list;
+	view_list = view;
+
+	return view;
 }
 
-PMATRIX CreateMatrix (
-	_In_ ULONG width,
-	_In_ ULONG height
+VOID DestroyMatrixView (
+	_Inout_ PMATRIX_VIEW *view
 )
 {
-	PMATRIX matrix;
-	HDC hdc;
-	ULONG numcols;
-	ULONG numrows;
+	PMATRIX_VIEW old_view;
+	PMATRIX_VIEW *link;
+
+	old_view = *view;
+	*view = NULL;
+
+	for (link = &view_list; *link; link = &(*link)->next)
+	{
+		if (*link == old_view)
+		{
+			*link = old_view->next;
+
+			break;
+		}
+	}
+
+	// the display thread could be in the middle of a frame
+	StopDisplay (&old_view->display);
+
+	MergeStats (&stats_total, &old_view->stats);
+	DeleteStats (&old_view->stats);
+
+	// previews are too small to start a fullscreen run from
+	if (old_view->matrix && !GetParent (old_view->hwnd))
+		SaveMatrixSnapshotFile (old_view->matrix);
 
-	numcols = width / GLYPH_WIDTH + 1;
-	numrows = height / GLYPH_HEIGHT + 1;
+	DestroyMatrixViewBitmap (old_view);
 
-	matrix = _r_mem_allocate (sizeof (MATRIX) + (sizeof (MATRIX_COLUMN) * numcols));
+	PlatformAcquireLock (&atlas_lock);
 
-	// there is no logic to check return value, because of this function thrown an exception when it failed, sooo...
-	//if (!matrix)
-	//	return NULL;
+	DereferenceAtlasScale (old_view->scale);
 
-	matrix->numcols = numcols;
-	matrix->numrows = numrows;
-	matrix->width = width;
-	matrix->height = height;
+	PlatformReleaseLock (&atlas_lock);
 
-	for (ULONG x = 0; x < numcols; x++)
+	PlatformDeleteLock (&old_view->lock);
+
+	if (old_view->matrix)
+		DestroyMatrix (&old_view->matrix);
+
+	_r_mem_free (old_view);
+}
+
+// window thread only, a new speed from the settings reaches running views
+VOID UpdateMatrixViewSpeed ()
+{
+	PMATRIX_VIEW view;
+
+	for (view = view_list; view; view = view->next)
 	{
-		matrix->column[x].length = numrows;
-		matrix->column[x].countdown = _r_math_getrandomrange (0, RND_MAX) % 100;
-		matrix->column[x].state = _r_math_getrandomrange (0, RND_MAX) % 2;
-		matrix->column[x].run_length = _r_math_getrandomrange (0, RND_MAX) % 20 + 3;
+		SetDisplayStep (&view->display, GetStepInterval () * 1000000ULL);
 
-		matrix->column[x].blip_length = matrix->column[x].length;
+		// without a display thread the timer is what wakes the view
+		if (!view->display.coordinator)
+			SetTimer (view->hwnd, UID, GetStepInterval (), 0);
 
-		matrix->column[x].glyph = _r_mem_allocate (sizeof (GLYPH) * (numrows + 16));
+		PlatformAcquireLock (&view->lock);
+
+		SetGovernorBudget (&view->governor, GetFrameBudget ());
+
+		PlatformReleaseLock (&view->lock);
 	}
+}
+
+VOID ResizeMatrixView (
+	_Inout_ PMATRIX_VIEW view,
+	_In_ ULONG width,
+	_In_ ULONG height,
+	_In_ ULONG dpi
+)
+{
+	ULONG scale;
 
-	hdc = GetDC (NULL);
+	scale = GetMatrixViewScale (width, height, dpi);
 
-	if (hdc)
+	if (view->width == width && view->height == height && view->scale == scale)
+		return;
+
+	PlatformAcquireLock (&view->lock);
+
+	// glyphs of the new size come from another cache, picked up by the next frame
+	if (view->scale != scale)
 	{
-		matrix->hdc = CreateCompatibleDC (hdc);
-		matrix->hbitmap = MakeBitmap (hdc, _r_sys_getimagebase (), IDR_GLYPH, config.hue);
+		PlatformAcquireLock (&atlas_lock);
 
-		SelectObject (matrix->hdc, matrix->hbitmap);
+		if (ReferenceAtlasScale (scale))
+		{
+			DereferenceAtlasScale (view->scale);
+
+			view->atlas = NULL;
+			view->kernel = GetRenderKernel (scale);
+			view->scale = scale;
+		}
 
-		ReleaseDC (NULL, hdc);
+		PlatformReleaseLock (&atlas_lock);
 	}
 
-	return matrix;
+	// columns and rows are added or dropped at the edges, the rest keeps falling
+	if (ResizeMatrix (&view->matrix, GetRenderColumns (width, view->scale), GetRenderRows (height, view->scale)))
+		PrepareWorkerPool (view->matrix);
+
+	CreateMatrixViewBitmap (view, width, height);
+
+	// the new frame buffer starts black, every glyph has to be drawn again
+	InvalidateMatrix (view->matrix);
+
+	view->width = width;
+	view->height = height;
+
+	PlatformReleaseLock (&view->lock);
 }
 
-VOID DestroyMatrix (
-	_Inout_ PMATRIX *matrix
+VOID FitMatrixViewToMonitor (
+	_In_ HWND hwnd
 )
 {
-	PMATRIX old_matrix;
-	PGLYPH glyph;
+	MONITORINFO monitor_info = {0};
+	HMONITOR hmonitor;
+
+	hmonitor = MonitorFromWindow (hwnd, MONITOR_DEFAULTTONEAREST);
+
+	monitor_info.cbSize = sizeof (monitor_info);
+
+	if (!hmonitor || !GetMonitorInfoW (hmonitor, &monitor_info))
+		return;
+
+	// the grid follows in WM_SIZE
+	SetWindowPos (
+		hwnd,
+		NULL,
+		monitor_info.rcMonitor.left,
+		monitor_info.rcMonitor.top,
+		_r_calc_rectwidth (&monitor_info.rcMonitor),
+		_r_calc_rectheight (&monitor_info.rcMonitor),
+		SWP_NOZORDER | SWP_NOACTIVATE
+	);
+}
 
-	old_matrix = *matrix;
-	*matrix = NULL;
+VOID CloseScreensaver (
+	_In_ HWND hwnd
+)
+{
+	PMATRIX_VIEW view;
 
-	DeleteDC (old_matrix->hdc);
-	DeleteObject (old_matrix->hbitmap);
+	// a preview only closes itself
+	if (GetParent (hwnd))
+	{
+		DestroyWindow (hwnd);
+		return;
+	}
 
-	for (ULONG_PTR x = 0; x < old_matrix->numcols; x++)
+	// input on one monitor stops the drawing on all of them at once, the
+	// preview of the settings window keeps running
+	for (view = view_list; view; view = view->next)
 	{
-		glyph = old_matrix->column[x].glyph;
+		if (!GetParent (view->hwnd))
+			RequestStopDisplay (&view->display);
+	}
 
-		if (glyph)
-		{
-			old_matrix->column[x].glyph = NULL;
+	view = view_list;
 
-			_r_mem_free (glyph);
+	while (view)
+	{
+		// a destroyed view is taken off the list, start over
+		if (!GetParent (view->hwnd) && DestroyWindow (view->hwnd))
+		{
+			view = view_list;
+		}
+		else
+		{
+			view = view->next;
 		}
 	}
-
-	_r_mem_free (old_matrix);
 }
 
 LRESULT CALLBACK ScreensaverProc (
@@ -503,7 +884,7 @@ LRESULT CALLBACK ScreensaverProc (
 	static POINT pt_cursor = {0};
 	static BOOLEAN is_savecursor = FALSE;
 
-	PMATRIX matrix;
+	PMATRIX_VIEW view;
 
 	switch (msg)
 	{
@@ -513,13 +894,16 @@ LRESULT CALLBACK ScreensaverProc (
 
 			pcs = (LPCREATESTRUCT)lparam;
 
-			matrix = CreateMatrix (pcs->cx, pcs->cy);
+			view = CreateMatrixView (hwnd, pcs->cx, pcs->cy);
 
-			if (!matrix)
+			if (!view)
 				return FALSE;
 
-			SetWindowLongPtrW (hwnd, GWLP_USERDATA, (LONG_PTR)matrix);
-			SetTimer (hwnd, UID, ((SPEED_MAX - config.speed) + SPEED_MIN) * 10, 0);
+			SetWindowLongPtrW (hwnd, GWLP_USERDATA, (LONG_PTR)view);
+
+			// every monitor gets its own thread, the timer is a fallback
+			if (!StartDisplay (&coordinator, &view->display, &DecodeMatrix, view))
+				SetTimer (hwnd, UID, GetStepInterval (), 0);
 
 			return TRUE;
 		}
@@ -529,13 +913,13 @@ LRESULT CALLBACK ScreensaverProc (
 			KillTimer (hwnd, UID);
 			is_savecursor = FALSE;
 
-			matrix = (PMATRIX)GetWindowLongPtr (hwnd, GWLP_USERDATA);
+			view = (PMATRIX_VIEW)GetWindowLongPtr (hwnd, GWLP_USERDATA);
 
-			if (matrix)
+			if (view)
 			{
 				SetWindowLongPtrW (hwnd, GWLP_USERDATA, 0);
 
-				DestroyMatrix (&matrix);
+				DestroyMatrixView (&view);
 			}
 
 			if (config.is_preview && !GetParent (hwnd))
@@ -553,12 +937,105 @@ LRESULT CALLBACK ScreensaverProc (
 			return FALSE;
 		}
 
+		case WM_SIZE:
+		{
+			view = (PMATRIX_VIEW)GetWindowLongPtr (hwnd, GWLP_USERDATA);
+
+			if (!view || wparam == SIZE_MINIMIZED)
+				break;
+
+			if (!LOWORD (lparam) || !HIWORD (lparam))
+				break;
+
+			ResizeMatrixView (view, LOWORD (lparam), HIWORD (lparam), _r_dc_getwindowdpi (hwnd));
+
+			break;
+		}
+
+		case WM_DISPLAYCHANGE:
+		{
+			// previews are sized by the parent window
+			if (!GetParent (hwnd))
+				FitMatrixViewToMonitor (hwnd);
+
+			break;
+		}
+
+		case WM_DPICHANGED:
+		{
+			if (!GetParent (hwnd))
+				FitMatrixViewToMonitor (hwnd);
+
+			view = (PMATRIX_VIEW)GetWindowLongPtr (hwnd, GWLP_USERDATA);
+
+			// the scaling can change without the size, then no WM_SIZE follows
+			if (view)
+				ResizeMatrixView (view, view->width, view->height, LOWORD (wparam));
+
+			return FALSE;
+		}
+
+		case WM_ERASEBKGND:
+		{
+			view = (PMATRIX_VIEW)GetWindowLongPtr (hwnd, GWLP_USERDATA);
+
+			// frame buffer covers the whole window
+			if (view && view->hdc)
+				return TRUE;
+
+			break;
+		}
+
+		case WM_PAINT:
+		{
+			PAINTSTRUCT ps;
+			HDC hdc;
+
+			hdc = BeginPaint (hwnd, &ps);
+
+			if (!hdc)
+				return FALSE;
+
+			view = (PMATRIX_VIEW)GetWindowLongPtr (hwnd, GWLP_USERDATA);
+
+			if (view && view->hdc)
+			{
+				PlatformAcquireLock (&view->lock);
+
+				BitBlt (
+					hdc,
+					ps.rcPaint.left,
+					ps.rcPaint.top,
+					_r_calc_rectwidth (&ps.rcPaint),
+					_r_calc_rectheight (&ps.rcPaint),
+					view->hdc,
+					ps.rcPaint.left,
+					ps.rcPaint.top,
+					SRCCOPY
+				);
+
+				PlatformReleaseLock (&view->lock);
+			}
+
+			EndPaint (hwnd, &ps);
+
+			return FALSE;
+		}
+
 		case WM_TIMER:
 		{
-			matrix = (PMATRIX)GetWindowLongPtr (hwnd, GWLP_USERDATA);
+			ULONG steps;
 
-			if (matrix)
-				DecodeMatrix (hwnd, matrix);
+			view = (PMATRIX_VIEW)GetWindowLongPtr (hwnd, GWLP_USERDATA);
+
+			if (!view)
+				return FALSE;
+
+			// timer ticks only wake us up and do not define the speed
+			steps = AdvanceScheduler (&view->display.scheduler);
+
+			if (steps)
+				DecodeMatrix (view, steps);
 
 			return FALSE;
 		}
@@ -569,7 +1046,7 @@ LRESULT CALLBACK ScreensaverProc (
 			if (wparam != VK_ESCAPE && config.is_esc_only)
 				return FALSE;
 
-			DestroyWindow (hwnd);
+			CloseScreensaver (hwnd);
 
 			return FALSE;
 		}
@@ -594,7 +1071,7 @@ LRESULT CALLBACK ScreensaverProc (
 
 			if (abs (pt_cursor.x - pt_last.x) >= (icon_size / 2) || abs (pt_cursor.y - pt_last.y) >= (icon_size / 2))
 			{
-				DestroyWindow (hwnd);
+				CloseScreensaver (hwnd);
 
 				return FALSE;
 			}
@@ -611,7 +1088,7 @@ LRESULT CALLBACK ScreensaverProc (
 			if (GetParent (hwnd) || config.is_esc_only)
 				return FALSE;
 
-			DestroyWindow (hwnd);
+			CloseScreensaver (hwnd);
 
 			break;
 		}
@@ -816,6 +1293,7 @@ INT_PTR CALLBACK SettingsProc (
 						break;
 
 					ReadSettings ();
+					UpdateMatrixViewSpeed ();
 
 					CheckDlgButton (hwnd, IDC_RANDOMIZECOLORS_CHK, config.is_random ? BST_CHECKED : BST_UNCHECKED);
 					CheckDlgButton (hwnd, IDC_RANDOMIZESMOOTH_CHK, config.is_smooth ? BST_CHECKED : BST_UNCHECKED);
@@ -856,7 +1334,12 @@ INT_PTR CALLBACK SettingsProc (
 
 					new_value = (LONG)SendDlgItemMessageW (hwnd, IDC_SPEED, UDM_GETPOS32, 0, 0);
 
-					config.speed = new_value;
+					if (config.speed != new_value)
+					{
+						config.speed = new_value;
+
+						UpdateMatrixViewSpeed ();
+					}
 
 					break;
 				}
@@ -918,7 +1401,7 @@ BOOLEAN RegisterClasses (
 	wcex.style = CS_VREDRAW | CS_HREDRAW | CS_SAVEBITS | CS_PARENTDC;
 	wcex.lpfnWndProc = &ScreensaverProc;
 	wcex.hbrBackground = GetStockObject (BLACK_BRUSH);
-	wcex.cbWndExtra = sizeof (PMATRIX);
+	wcex.cbWndExtra = sizeof (PMATRIX_VIEW);
 
 	wcex.lpszClassName = CLASS_PREVIEW;
 	wcex.hCursor = LoadCursorW (NULL, IDC_ARROW);
@@ -951,6 +1434,7 @@ INT APIENTRY wWinMain (
 )
 {
 	R_STRINGREF sr;
+	PMATRIX_VIEW view;
 	HWND hwnd = NULL;
 	MSG msg;
 
@@ -960,6 +1444,12 @@ INT APIENTRY wWinMain (
 	// read settings
 	ReadSettings ();
 
+	if (!InitializeStats (&stats_total, 0, config.is_trace ? STATS_TRACE_EVENTS * DISPLAY_MAX : 0))
+		InitializeStats (&stats_total, 0, 0);
+
+	PlatformInitializeLock (&atlas_lock);
+	InitializeCoordinator (&coordinator);
+
 	// register classes
 	if (!RegisterClasses (hinst))
 		goto CleanupExit;
@@ -1006,6 +1496,43 @@ INT APIENTRY wWinMain (
 
 CleanupExit:
 
+	// a close that did not come from input (WM_CLOSE, a session ending)
+	// leaves the windows on other monitors open, they all stop drawing here
+	for (view = view_list; view; view = view->next)
+		RequestStopDisplay (&view->display);
+
+	// each one merges its stats and saves its snapshot when it goes
+	while (view_list)
+	{
+		view = view_list;
+
+		// the window is already gone, only the view is left
+		if (!DestroyWindow (view->hwnd))
+			DestroyMatrixView (&view);
+	}
+
+	DeleteCoordinator (&coordinator);
+
+	// every view has been merged by now
+	stats_total.counter[StatsAllocations] = GetMatrixAllocationCount ();
+
+	if (config.is_stats)
+		SaveStatsFile (STATS_NAME, FALSE);
+
+	if (config.is_trace)
+		SaveStatsFile (TRACE_NAME, TRUE);
+
+	DeleteStats (&stats_total);
+
+	for (ULONG i = 1; i < ATLAS_SCALE_MAX; i++)
+		AtlasFreeScaledSource (&atlas_source[i]);
+
+	FreeAtlasSource (&atlas_source[0]);
+	FlushMatrixPool ();
+
+	// the display threads are joined, nothing reads it any more
+	DestroyWorkerPool ((PWORKER_POOL *)&worker_pool);
+
 	UnregisterClassW (CLASS_PREVIEW, hinst);
 	UnregisterClassW (CLASS_FULLSCREEN, hinst);
 
@@ -9,28 +9,42 @@
 #include "resource.h"
 #include "app.h"
 
+#include "atlas.h"
+#include "display.h"
+#include "governor.h"
+#include "matrix.h"
+#include "render.h"
+#include "scheduler.h"
+#include "stats.h"
+
 // config
 #define UID 0xDEADBEEF
 
 #define CLASS_FULLSCREEN APP_NAME_SHORT L"_Fullscreen"
 #define CLASS_PREVIEW APP_NAME_SHORT L"_Preview"
 
-#define GLYPH_REDRAW 0x8000
-#define GLYPH_BLANK 0x4000
-#define RND_MASK 0xB400
-
-#define AMOUNT_MIN 1
-#define AMOUNT_MAX 26
-#define AMOUNT_DEFAULT 26
-
-#define DENSITY_MIN 5
-#define DENSITY_MAX 50
-#define DENSITY_DEFAULT 30
-
 #define SPEED_MIN 1
 #define SPEED_MAX 10
 #define SPEED_DEFAULT 6
 
+#define THREADS_DEFAULT 0 // one per processor
+
+#define RENDER_SCALE_DEFAULT 0 // from the monitor dpi and the cell target
+
+#define STEPS_MAX 4 // catch-up steps per timer tick
+
+#define ADAPTIVE_DEFAULT TRUE
+#define ADAPTIVE_BUDGET_PERCENT 75 // share of a step the simulation and drawing may take
+
+// simulation state kept between runs for a warm start
+#define SNAPSHOT_DIRECTORY L"%LOCALAPPDATA%\\" APP_NAME_SHORT
+#define SNAPSHOT_NAME L"snapshot.bin"
+#define SNAPSHOT_TEMP_NAME L"snapshot.tmp"
+
+// counters and histograms written on exit, next to the snapshot
+#define STATS_NAME L"stats.json"
+#define TRACE_NAME L"trace.json"
+
 #define HUE_MIN 1
 #define HUE_MAX 255
 #define HUE_DEFAULT 85
@@ -38,54 +52,71 @@
 #define HUE_RANDOM FALSE
 #define HUE_RANDOM_SMOOTHTRANSITION TRUE
 
-// constants inferred from matrix.bmp
-#define MAX_INTENSITY 5 // number of intensity levels
-#define GLYPH_WIDTH 14 // width of each glyph (pixels)
-#define GLYPH_HEIGHT 14 // height of each glyph (pixels)
-
 typedef struct _STATIC_DATA
 {
 	LONG amount;
 	LONG density;
 	LONG speed;
 	LONG hue;
+	LONG threads;
+	LONG render_scale;
+	LONG cells_target;
 	BOOLEAN is_esc_only;
+	BOOLEAN is_adaptive;
+	BOOLEAN is_stats;
+	BOOLEAN is_trace;
 	BOOLEAN is_random;
 	BOOLEAN is_smooth;
 	BOOLEAN is_preview;
 } STATIC_DATA, *PSTATIC_DATA;
 
-typedef ULONG GLYPH;
-typedef PULONG PGLYPH;
+typedef struct _STATS_FILE
+{
+	HANDLE hfile;
+	ULONG length;
+	CHAR buffer[0x10000];
+} STATS_FILE, *PSTATS_FILE;
 
-//	The "matrix" is basically an array of these
-//  column structures, positioned side-by-side
-typedef struct _MATRIX_COLUMN
+typedef struct _MATRIX_VIEW
 {
-	PGLYPH glyph;
+	// next in the list of views, kept by the window thread
+	struct _MATRIX_VIEW *next;
 
-	ULONG_PTR run_length;
-	ULONG_PTR length;
+	// frame buffer dib selected into a memory dc
+	HDC hdc;
+	HBITMAP hbitmap;
+	HGDIOBJ hbitmap_old;
 
-	ULONG_PTR blip_length;
-	ULONG_PTR blip_pos;
+	FRAMEBUFFER framebuffer;
 
-	LONG state;
-	LONG countdown;
+	// image for the current hue, held in the shared atlas cache
+	PCATLAS_IMAGE atlas;
 
-	BOOLEAN is_started;
-} MATRIX_COLUMN, *PMATRIX_COLUMN;
+	// cell kernel for the glyph size of the atlas, changes with the scale
+	PMATRIX_DRAW_CALLBACK kernel;
 
-typedef struct _MATRIX
-{
-	// bitmap containing glyphs.
-	HDC hdc;
-	HBITMAP hbitmap;
+	PMATRIX matrix;
+
+	// display thread and its simulation clock
+	DISPLAY display;
+
+	// drops the frame rate on machines too slow for the step interval
+	GOVERNOR governor;
+
+	ULONG64 pending_cost;
+	ULONG pending_steps;
+
+	// owned by the display thread, merged on exit
+	STATS stats;
+
+	// held while the grid or the frame buffer is used
+	PLATFORM_LOCK lock;
+
+	HWND hwnd;
 
 	ULONG width;
 	ULONG height;
-	ULONG numcols;
-	ULONG numrows;
+	ULONG scale;
 
-	MATRIX_COLUMN column[1];
-} MATRIX, *PMATRIX;
+	LONG hue;
+} MATRIX_VIEW, *PMATRIX_VIEW;
@@ -0,0 +1,1343 @@
+// Matrix Screensaver
+// Copyright (c) J Brown 2003 (catch22.net)
+// Copyright (c) 2011-2026 Henry++
+
+#include "matrix.h"
+
+//
+// redraw state is kept out of the glyphs, every changed row sets its
+// bit in the column bitmap and the column bit in the matrix bitmap.
+//
+FORCEINLINE VOID MarkGlyph (
+	_Inout_ PMATRIX matrix,
+	_Inout_ PMATRIX_COLUMN column,
+	_In_ ULONG_PTR y
+)
+{
+	ULONG x;
+
+	// rows past the end are never drawn
+	if (y >= column->length)
+		return;
+
+	x = (ULONG)(column - matrix->column);
+
+	column->dirty[y / 64] |= 1ULL << (y % 64);
+
+	// neighbour blocks may live on the same cache line, write once per frame
+	if (!(matrix->dirty_columns[x / 64] & (1ULL << (x % 64))))
+		matrix->dirty_columns[x / 64] |= 1ULL << (x % 64);
+}
+
+//
+// keeps the boundary bits of rows y and y + 1 in step with the glyphs,
+// called for every row whose intensity was changed.
+//
+FORCEINLINE VOID UpdateBoundary (
+	_Inout_ PMATRIX_COLUMN column,
+	_In_ ULONG_PTR y
+)
+{
+	ULONG_PTR end;
+	ULONG64 bit;
+
+	end = (y + 2 < column->length) ? y + 2 : column->length;
+
+	for (ULONG_PTR i = y ? y : 1; i < end; i++)
+	{
+		bit = 1ULL << (i % 64);
+
+		if (GlyphIntensity (column->glyph[i]) != GlyphIntensity (column->glyph[i - 1]))
+		{
+			column->boundary[i / 64] |= bit;
+		}
+		else
+		{
+			column->boundary[i / 64] &= ~bit;
+		}
+	}
+}
+
+// first head or tail at or below y, length if there is none
+FORCEINLINE ULONG_PTR NextBoundary (
+	_In_ PMATRIX matrix,
+	_In_ PMATRIX_COLUMN column,
+	_In_ ULONG_PTR y
+)
+{
+	ULONG64 bits;
+	ULONG_PTR w;
+
+	if (y >= column->length)
+		return column->length;
+
+	w = y / 64;
+	bits = column->boundary[w] & (~0ULL << (y % 64));
+
+	while (!bits)
+	{
+		if (++w >= matrix->dirty_stride)
+			return column->length;
+
+		bits = column->boundary[w];
+	}
+
+	return (w * 64) + PlatformCountTrailingZeros64 (bits);
+}
+
+FORCEINLINE GLYPH RandomGlyph (
+	_In_ PMATRIX matrix,
+	_Inout_ PMATRIX_COLUMN column,
+	_In_ INT intensity
+)
+{
+	return (GLYPH)((intensity << 8) | RandomBounded (&column->random, matrix->amount));
+}
+
+FORCEINLINE GLYPH DarkenGlyph (
+	_In_ GLYPH glyph
+)
+{
+	GLYPH intensity;
+
+	intensity = GlyphIntensity (glyph);
+
+	if (intensity > 0)
+		return (GLYPH)(((intensity - 1) << 8) | (glyph & 0x00FF));
+
+	return glyph;
+}
+
+FORCEINLINE VOID RedrawBlip (
+	_Inout_ PMATRIX matrix,
+	_Inout_ PMATRIX_COLUMN column,
+	_In_ ULONG_PTR blip_pos
+)
+{
+	MarkGlyph (matrix, column, blip_pos + 0);
+	MarkGlyph (matrix, column, blip_pos + 1);
+	MarkGlyph (matrix, column, blip_pos + 8);
+	MarkGlyph (matrix, column, blip_pos + 9);
+}
+
+FORCEINLINE VOID AdvanceBlip (
+	_Inout_ PMATRIX_COLUMN column
+)
+{
+	// advance down screen at double-speed
+	column->blip_pos += 2;
+
+	// if the blip gets to the end of a run, start it again (for a random
+	// length so that the blips never get synched together)
+	if (column->blip_pos >= column->blip_length)
+	{
+		column->blip_length = column->length + RandomBounded (&column->random, MATRIX_BLIP_RESTART);
+		column->blip_pos = 0;
+	}
+}
+
+FORCEINLINE VOID MoveBlip (
+	_Inout_ PMATRIX matrix,
+	_Inout_ PMATRIX_COLUMN column
+)
+{
+	// mark current blip as redraw so it gets "erased"
+	if (column->blip_pos < column->length)
+		RedrawBlip (matrix, column, column->blip_pos);
+
+	AdvanceBlip (column);
+
+	// now redraw blip at new position
+	if (column->blip_pos < column->length)
+		RedrawBlip (matrix, column, column->blip_pos);
+}
+
+VOID ScrollMatrixColumn (
+	_Inout_ PMATRIX matrix,
+	_Inout_ PMATRIX_COLUMN column
+)
+{
+	GLYPH last_glyph_intensity;
+	GLYPH current_glyph;
+	GLYPH current_glyph_intensity;
+	ULONG_PTR y;
+	LONG density;
+
+	// wait until we are allowed to scroll
+	if (!column->is_started)
+	{
+		if (--column->countdown <= 0)
+			column->is_started = TRUE;
+
+		return;
+	}
+
+	// "seed" the glyph-run
+	last_glyph_intensity = column->state ? 0 : MAX_INTENSITY;
+
+	//
+	// visit the changes in intensity/darkness, they signify the start/end
+	// of a run of glyphs. a row that matches the row above it would not
+	// change, so only row 0 and the boundary rows are looked at, and the
+	// bits are kept current as rows are changed on the way down.
+	//
+	for (y = 0; y < column->length; y = NextBoundary (matrix, column, y + 1))
+	{
+		if (y)
+			last_glyph_intensity = GlyphIntensity (column->glyph[y - 1]);
+
+		current_glyph = column->glyph[y];
+
+		current_glyph_intensity = GlyphIntensity (current_glyph);
+
+		// bottom-most part of "run". Insert a new character (glyph)
+		// at the end to lengthen the run down the screen..gives the
+		// impression that the run is "falling" down the screen
+		if (current_glyph_intensity < last_glyph_intensity && current_glyph_intensity == 0)
+		{
+			column->glyph[y] = RandomGlyph (matrix, column, MAX_INTENSITY - 1);
+
+			MarkGlyph (matrix, column, y);
+			UpdateBoundary (column, y);
+
+			y += 1;
+		}
+
+		// top-most part of "run". Delete a character off the top by
+		// darkening the glyph until it eventually disappears (turns black).
+		// this gives the effect that the run has dropped downwards
+		else if (current_glyph_intensity > last_glyph_intensity)
+		{
+			column->glyph[y] = DarkenGlyph (current_glyph);
+
+			MarkGlyph (matrix, column, y);
+			UpdateBoundary (column, y);
+
+			// if we've just darkened the last bit, skip on so
+			// the whole run doesn't go dark
+			if (current_glyph_intensity == MAX_INTENSITY - 1)
+				y++;
+		}
+	}
+
+	// change state from blanks <-> runs when the current run has expired
+	if (--column->run_length <= 0)
+	{
+		density = DENSITY_MAX - matrix->density + DENSITY_MIN;
+
+		if (column->state ^= 1)
+		{
+			column->run_length = RandomBounded (&column->random, 3 * density / 2) + DENSITY_MIN;
+		}
+		else
+		{
+			column->run_length = RandomBounded (&column->random, DENSITY_MAX + 1 - density) + (DENSITY_MIN * 2);
+		}
+	}
+
+	MoveBlip (matrix, column);
+}
+
+// a column that got shorter keeps its blip, one past the new end restarts
+// as it would have from the end of the column
+FORCEINLINE VOID TrimMatrixBlip (
+	_Inout_ PMATRIX_COLUMN column
+)
+{
+	ULONG_PTR limit;
+
+	limit = column->length + MATRIX_BLIP_RESTART - 1;
+
+	if (column->blip_length > limit)
+		column->blip_length = limit;
+
+	if (column->blip_pos > column->blip_length)
+		column->blip_pos = column->blip_length;
+}
+
+//
+// randomly change a small collection glyphs in a column
+//
+VOID RandomMatrixColumn (
+	_Inout_ PMATRIX matrix,
+	_Inout_ PMATRIX_COLUMN column
+)
+{
+	ULONG draws[30];
+	PULONG value;
+
+	value = NULL;
+
+	for (ULONG_PTR i = 1, y = 0; i < 16; i++)
+	{
+		// find a run, rows between boundaries share one intensity
+		while (y < column->length && GlyphIntensity (column->glyph[y]) < (MAX_INTENSITY - 1))
+			y = NextBoundary (matrix, column, y + 1);
+
+		if (y >= column->length)
+			break;
+
+		// draw numbers for the whole pass at once, two per change
+		if (!value)
+		{
+			RandomFill (&column->random, draws, RTL_NUMBER_OF (draws));
+
+			value = draws;
+		}
+
+		column->glyph[y] = (GLYPH)((column->glyph[y] & 0xFF00) | RandomReduce (&column->random, *value++, matrix->amount));
+
+		MarkGlyph (matrix, column, y);
+
+		y += RandomReduce (&column->random, *value++, 10);
+	}
+}
+
+// bits of the blip rows, the same as RedrawBlip marks, that fall into dirty word w
+FORCEINLINE ULONG64 GetBlipMask (
+	_In_ ULONG_PTR blip_pos,
+	_In_ ULONG w
+)
+{
+	static CONST ULONG_PTR offsets[] = {0, 1, 8, 9};
+	ULONG64 mask = 0;
+	ULONG_PTR y;
+
+	for (ULONG i = 0; i < RTL_NUMBER_OF (offsets); i++)
+	{
+		y = blip_pos + offsets[i];
+
+		if (y / 64 == w)
+			mask |= 1ULL << (y % 64);
+	}
+
+	return mask;
+}
+
+ULONG RedrawMatrixColumn (
+	_Inout_ PMATRIX matrix,
+	_Inout_ PMATRIX_COLUMN column,
+	_In_ ULONG x,
+	_In_ PMATRIX_DRAW_CALLBACK callback,
+	_In_opt_ PVOID context
+)
+{
+	GLYPH glyph;
+	ULONG64 bits;
+	ULONG64 blip;
+	ULONG_PTR i;
+	ULONG count = 0;
+
+	// walk only the rows that need doing
+	for (ULONG w = 0; w < matrix->dirty_stride; w++)
+	{
+		bits = column->dirty[w];
+
+		if (!bits)
+			continue;
+
+		// clear redraw state
+		column->dirty[w] = 0;
+
+		// blip rows of this word, tested once instead of four times per row
+		blip = GetBlipMask (column->blip_pos, w);
+
+		do
+		{
+			i = ((ULONG_PTR)w * 64) + PlatformCountTrailingZeros64 (bits);
+			bits &= bits - 1;
+
+			glyph = column->glyph[i];
+
+			if ((blip & (1ULL << (i % 64))) && GlyphIntensity (glyph) >= MAX_INTENSITY - 1)
+				glyph = (GLYPH)(glyph | (MAX_INTENSITY << 8));
+
+			callback (context, x, (ULONG)i, glyph);
+
+			count += 1;
+		}
+		while (bits);
+	}
+
+	return count;
+}
+
+//
+// a column sleeps through the steps that would not change its glyphs:
+// until the countdown runs out, and in the blank state while every row is
+// dark. a blank column still moves its blip so the restarts keep drawing
+// from its random stream, the rest is a countdown caught up when it wakes.
+//
+static ULONG_PTR GetMatrixColumnIdleSteps (
+	_In_ PMATRIX matrix,
+	_In_ PMATRIX_COLUMN column
+)
+{
+	// a lit row would be changed by RandomMatrixColumn
+	if (GlyphIntensity (column->glyph[0]) || NextBoundary (matrix, column, 1) < column->length)
+		return 0;
+
+	// the step that starts the column does nothing else
+	if (!column->is_started)
+		return (column->countdown > 0) ? (ULONG_PTR)column->countdown : 1;
+
+	// the step that ends the blanks draws the next run
+	if (column->state && column->run_length > 1)
+		return column->run_length - 1;
+
+	return 0;
+}
+
+static VOID CatchUpMatrixColumn (
+	_Inout_ PMATRIX_COLUMN column,
+	_In_ ULONG_PTR steps
+)
+{
+	if (!column->is_started)
+	{
+		column->countdown -= (LONG)steps;
+
+		if (column->countdown <= 0)
+			column->is_started = TRUE;
+
+		return;
+	}
+
+	column->run_length -= steps;
+}
+
+FORCEINLINE VOID SleepMatrixColumn (
+	_Inout_ PMATRIX matrix,
+	_In_ ULONG x
+)
+{
+	PMATRIX_COLUMN column;
+	ULONG_PTR steps;
+
+	column = &matrix->column[x];
+
+	steps = GetMatrixColumnIdleSteps (matrix, column);
+
+	if (!steps)
+		return;
+
+	column->sleep_step = matrix->step;
+	column->wake_step = matrix->step + steps + 1;
+
+	// blocks own whole words of the bitmaps
+	matrix->active_columns[x / 64] &= ~(1ULL << (x % 64));
+	matrix->sleeping_columns[x / 64] |= 1ULL << (x % 64);
+
+	if (column->is_started)
+		matrix->blank_columns[x / 64] |= 1ULL << (x % 64);
+}
+
+// brings the column up to date as of the step and puts it back in the active set
+static VOID WakeMatrixColumn (
+	_Inout_ PMATRIX matrix,
+	_In_ ULONG x,
+	_In_ ULONG64 step
+)
+{
+	PMATRIX_COLUMN column;
+
+	column = &matrix->column[x];
+
+	CatchUpMatrixColumn (column, (ULONG_PTR)(step - column->sleep_step));
+
+	column->sleep_step = 0;
+	column->wake_step = 0;
+
+	matrix->active_columns[x / 64] |= 1ULL << (x % 64);
+	matrix->blank_columns[x / 64] &= ~(1ULL << (x % 64));
+}
+
+// timer heap ordered by wake step, then by column
+FORCEINLINE BOOLEAN IsMatrixTimerBefore (
+	_In_ PMATRIX matrix,
+	_In_ ULONG a,
+	_In_ ULONG b
+)
+{
+	if (matrix->column[a].wake_step != matrix->column[b].wake_step)
+		return matrix->column[a].wake_step < matrix->column[b].wake_step;
+
+	return a < b;
+}
+
+static VOID PushMatrixTimer (
+	_Inout_ PMATRIX matrix,
+	_In_ ULONG x
+)
+{
+	ULONG i;
+	ULONG parent;
+
+	i = matrix->timer_count++;
+
+	while (i)
+	{
+		parent = (i - 1) / 2;
+
+		if (!IsMatrixTimerBefore (matrix, x, matrix->timers[parent]))
+			break;
+
+		matrix->timers[i] = matrix->timers[parent];
+		i = parent;
+	}
+
+	matrix->timers[i] = x;
+}
+
+static ULONG PopMatrixTimer (
+	_Inout_ PMATRIX matrix
+)
+{
+	ULONG first;
+	ULONG last;
+	ULONG child;
+	ULONG i = 0;
+
+	first = matrix->timers[0];
+	last = matrix->timers[--matrix->timer_count];
+
+	while ((child = (i * 2) + 1) < matrix->timer_count)
+	{
+		if (child + 1 < matrix->timer_count && IsMatrixTimerBefore (matrix, matrix->timers[child + 1], matrix->timers[child]))
+			child += 1;
+
+		if (!IsMatrixTimerBefore (matrix, matrix->timers[child], last))
+			break;
+
+		matrix->timers[i] = matrix->timers[child];
+		i = child;
+	}
+
+	if (matrix->timer_count)
+		matrix->timers[i] = last;
+
+	return first;
+}
+
+// every sleeping column is caught up, for changes the sleep did not account for
+static VOID WakeMatrix (
+	_Inout_ PMATRIX matrix
+)
+{
+	while (matrix->timer_count)
+		WakeMatrixColumn (matrix, PopMatrixTimer (matrix), matrix->step);
+}
+
+static VOID BeginMatrixStep (
+	_Inout_ PMATRIX matrix
+)
+{
+	ULONG x;
+
+	matrix->step += 1;
+
+	while (matrix->timer_count)
+	{
+		x = matrix->timers[0];
+
+		if (matrix->column[x].wake_step > matrix->step)
+			break;
+
+		PopMatrixTimer (matrix);
+
+		WakeMatrixColumn (matrix, x, matrix->step - 1);
+	}
+}
+
+static VOID EndMatrixStep (
+	_Inout_ PMATRIX matrix
+)
+{
+	ULONG64 bits;
+	ULONG words;
+
+	words = (matrix->numcols + 63) / 64;
+
+	for (ULONG w = 0; w < words; w++)
+	{
+		bits = matrix->sleeping_columns[w];
+
+		if (!bits)
+			continue;
+
+		matrix->sleeping_columns[w] = 0;
+
+		do
+		{
+			PushMatrixTimer (matrix, (w * 64) + PlatformCountTrailingZeros64 (bits));
+			bits &= bits - 1;
+		}
+		while (bits);
+	}
+}
+
+static VOID UpdateMatrixColumns (
+	_In_opt_ PVOID context,
+	_In_ ULONG begin,
+	_In_ ULONG end
+)
+{
+	PMATRIX_COLUMN column;
+	PMATRIX matrix;
+	ULONG64 bits;
+	ULONG x;
+
+	matrix = context;
+
+	// blocks start on a word and end on one or at numcols, see MATRIX_BLOCK_COLUMNS
+	for (ULONG w = begin / 64; w < (end + 63) / 64; w++)
+	{
+		bits = matrix->active_columns[w] | matrix->blank_columns[w];
+
+		while (bits)
+		{
+			x = (w * 64) + PlatformCountTrailingZeros64 (bits);
+			bits &= bits - 1;
+
+			column = &matrix->column[x];
+
+			// the blip only lights bright rows, over dark ones it draws nothing new
+			if (matrix->blank_columns[w] & (1ULL << (x % 64)))
+			{
+				AdvanceBlip (column);
+
+				continue;
+			}
+
+			RandomMatrixColumn (matrix, column);
+			ScrollMatrixColumn (matrix, column);
+
+			SleepMatrixColumn (matrix, x);
+		}
+	}
+}
+
+VOID UpdateMatrix (
+	_Inout_ PMATRIX matrix
+)
+{
+	BeginMatrixStep (matrix);
+
+	UpdateMatrixColumns (matrix, 0, matrix->numcols);
+
+	EndMatrixStep (matrix);
+}
+
+VOID UpdateMatrixParallel (
+	_Inout_ PMATRIX matrix,
+	_In_opt_ PWORKER_POOL pool
+)
+{
+	BeginMatrixStep (matrix);
+
+	// every column has its own random stream, so the split does not
+	// change the output
+	if (!pool || matrix->numcols < MATRIX_PARALLEL_COLUMNS)
+	{
+		UpdateMatrixColumns (matrix, 0, matrix->numcols);
+	}
+	else
+	{
+		RunWorkerPool (pool, matrix->numcols, MATRIX_BLOCK_COLUMNS, &UpdateMatrixColumns, matrix);
+	}
+
+	EndMatrixStep (matrix);
+}
+
+ULONG GetMatrixActiveColumns (
+	_In_ PMATRIX matrix
+)
+{
+	ULONG count = 0;
+
+	for (ULONG w = 0; w < (matrix->numcols + 63) / 64; w++)
+		count += PlatformPopulationCount64 (matrix->active_columns[w]);
+
+	return count;
+}
+
+ULONG RedrawMatrix (
+	_Inout_ PMATRIX matrix,
+	_In_ PMATRIX_DRAW_CALLBACK callback,
+	_In_opt_ PVOID context
+)
+{
+	ULONG64 bits;
+	ULONG count = 0;
+	ULONG words;
+	ULONG x;
+
+	words = (matrix->numcols + 63) / 64;
+
+	// columns without dirty rows are skipped entirely
+	for (ULONG w = 0; w < words; w++)
+	{
+		bits = matrix->dirty_columns[w];
+
+		if (!bits)
+			continue;
+
+		matrix->dirty_columns[w] = 0;
+
+		do
+		{
+			x = (w * 64) + PlatformCountTrailingZeros64 (bits);
+			bits &= bits - 1;
+
+			count += RedrawMatrixColumn (matrix, &matrix->column[x], x, callback, context);
+		}
+		while (bits);
+	}
+
+	return count;
+}
+
+typedef struct _MATRIX_LAYOUT
+{
+	SIZE_T cells_offset;
+	SIZE_T dirty_offset;
+	SIZE_T boundary_offset;
+	SIZE_T dirty_columns_offset;
+	SIZE_T active_columns_offset;
+	SIZE_T sleeping_columns_offset;
+	SIZE_T blank_columns_offset;
+	SIZE_T timers_offset;
+	SIZE_T size;
+
+	ULONG stride;
+	ULONG dirty_stride;
+} MATRIX_LAYOUT, *PMATRIX_LAYOUT;
+
+FORCEINLINE VOID MatrixLayout (
+	_In_ ULONG numcols,
+	_In_ ULONG numrows,
+	_Out_ PMATRIX_LAYOUT layout
+)
+{
+	SIZE_T offset;
+
+	offset = sizeof (MATRIX) + (sizeof (MATRIX_COLUMN) * numcols);
+
+	// every column starts on its own cache line
+	layout->stride = (ULONG)PLATFORM_ALIGN_UP (numrows + MATRIX_PADDING, MATRIX_ALIGNMENT / sizeof (GLYPH));
+	layout->cells_offset = PLATFORM_ALIGN_UP (offset, MATRIX_ALIGNMENT);
+
+	offset = layout->cells_offset + (sizeof (GLYPH) * (SIZE_T)layout->stride * numcols);
+
+	layout->dirty_stride = (numrows + 63) / 64;
+	layout->dirty_offset = PLATFORM_ALIGN_UP (offset, MATRIX_ALIGNMENT);
+
+	offset = layout->dirty_offset + (sizeof (ULONG64) * (SIZE_T)layout->dirty_stride * numcols);
+
+	// run boundaries use the same geometry as the dirty bits
+	layout->boundary_offset = offset;
+
+	offset = layout->boundary_offset + (sizeof (ULONG64) * (SIZE_T)layout->dirty_stride * numcols);
+
+	layout->dirty_columns_offset = offset;
+
+	// the scheduler bitmaps are laid out like dirty_columns
+	layout->active_columns_offset = layout->dirty_columns_offset + (sizeof (ULONG64) * (SIZE_T)((numcols + 63) / 64));
+	layout->sleeping_columns_offset = layout->active_columns_offset + (sizeof (ULONG64) * (SIZE_T)((numcols + 63) / 64));
+	layout->blank_columns_offset = layout->sleeping_columns_offset + (sizeof (ULONG64) * (SIZE_T)((numcols + 63) / 64));
+	layout->timers_offset = layout->blank_columns_offset + (sizeof (ULONG64) * (SIZE_T)((numcols + 63) / 64));
+
+	layout->size = layout->timers_offset + (sizeof (ULONG) * (SIZE_T)numcols);
+}
+
+//
+// released matrices are kept here, so a preview restart reuses the
+// previous block instead of going to the heap again. screensaver
+// windows are created and destroyed on one thread.
+//
+static PMATRIX matrix_pool[MATRIX_POOL_SIZE] = {0};
+static ULONG matrix_pool_count = 0;
+
+static ULONG64 matrix_allocations = 0;
+
+FORCEINLINE PMATRIX MatrixPoolAcquire (
+	_In_ SIZE_T size
+)
+{
+	PMATRIX matrix;
+	ULONG best = MATRIX_POOL_SIZE;
+
+	// take the smallest block that fits
+	for (ULONG i = 0; i < matrix_pool_count; i++)
+	{
+		if (matrix_pool[i]->size < size)
+			continue;
+
+		if (best == MATRIX_POOL_SIZE || matrix_pool[i]->size < matrix_pool[best]->size)
+			best = i;
+	}
+
+	if (best == MATRIX_POOL_SIZE)
+		return NULL;
+
+	matrix = matrix_pool[best];
+	matrix_pool[best] = matrix_pool[--matrix_pool_count];
+
+	return matrix;
+}
+
+FORCEINLINE BOOLEAN MatrixPoolRelease (
+	_In_ PMATRIX matrix
+)
+{
+	if (matrix_pool_count >= MATRIX_POOL_SIZE)
+		return FALSE;
+
+	matrix_pool[matrix_pool_count++] = matrix;
+
+	return TRUE;
+}
+
+VOID FlushMatrixPool ()
+{
+	while (matrix_pool_count)
+		PlatformFreeAligned (matrix_pool[--matrix_pool_count]);
+}
+
+ULONG64 GetMatrixAllocationCount ()
+{
+	return matrix_allocations;
+}
+
+static PMATRIX AllocateMatrix (
+	_In_ ULONG numcols,
+	_In_ ULONG numrows
+)
+{
+	MATRIX_LAYOUT layout;
+	PMATRIX matrix;
+	PMATRIX_COLUMN column;
+	SIZE_T capacity;
+
+	MatrixLayout (numcols, numrows, &layout);
+
+	matrix = MatrixPoolAcquire (layout.size);
+
+	if (matrix)
+	{
+		capacity = matrix->size;
+	}
+	else
+	{
+		matrix = PlatformAllocateAligned (layout.size, MATRIX_ALIGNMENT);
+
+		if (!matrix)
+			return NULL;
+
+		matrix_allocations += 1;
+
+		capacity = layout.size;
+	}
+
+	RtlZeroMemory (matrix, layout.size);
+
+	matrix->size = capacity;
+	matrix->stride = layout.stride;
+	matrix->cells = (PGLYPH)((PUCHAR)matrix + layout.cells_offset);
+
+	matrix->dirty_stride = layout.dirty_stride;
+	matrix->dirty_columns = (PULONG64)((PUCHAR)matrix + layout.dirty_columns_offset);
+
+	matrix->active_columns = (PULONG64)((PUCHAR)matrix + layout.active_columns_offset);
+	matrix->sleeping_columns = (PULONG64)((PUCHAR)matrix + layout.sleeping_columns_offset);
+	matrix->blank_columns = (PULONG64)((PUCHAR)matrix + layout.blank_columns_offset);
+	matrix->timers = (PULONG)((PUCHAR)matrix + layout.timers_offset);
+
+	matrix->numcols = numcols;
+	matrix->numrows = numrows;
+	matrix->column_capacity = numcols;
+
+	matrix->amount = AMOUNT_DEFAULT;
+	matrix->density = DENSITY_DEFAULT;
+
+	for (ULONG x = 0; x < numcols; x++)
+	{
+		column = &matrix->column[x];
+
+		column->glyph = matrix->cells + ((SIZE_T)layout.stride * x);
+		column->dirty = (PULONG64)((PUCHAR)matrix + layout.dirty_offset) + ((SIZE_T)layout.dirty_stride * x);
+		column->boundary = (PULONG64)((PUCHAR)matrix + layout.boundary_offset) + ((SIZE_T)layout.dirty_stride * x);
+	}
+
+	return matrix;
+}
+
+// new column state, the storage pointers and the glyphs are kept
+static VOID ResetMatrixColumn (
+	_Inout_ PMATRIX matrix,
+	_In_ ULONG x
+)
+{
+	PMATRIX_COLUMN column;
+
+	column = &matrix->column[x];
+
+	RandomSeed (&column->random, matrix->seed, x);
+
+	column->length = matrix->numrows;
+	column->countdown = RandomBounded (&column->random, 100);
+	column->state = RandomBounded (&column->random, 2);
+	column->run_length = RandomBounded (&column->random, 20) + 3;
+
+	column->blip_length = column->length;
+	column->blip_pos = 0;
+
+	column->sleep_step = 0;
+	column->wake_step = 0;
+
+	column->is_started = FALSE;
+
+	// updated once, it falls asleep on its own
+	matrix->active_columns[x / 64] |= 1ULL << (x % 64);
+}
+
+// zeroes rows from y on, glyphs as well as their bits
+static VOID TrimMatrixColumn (
+	_Inout_ PMATRIX matrix,
+	_Inout_ PMATRIX_COLUMN column,
+	_In_ ULONG y
+)
+{
+	ULONG64 mask;
+
+	RtlZeroMemory (column->glyph + y, sizeof (GLYPH) * (matrix->stride - y));
+
+	for (ULONG w = y / 64; w < matrix->dirty_stride; w++)
+	{
+		mask = (w == y / 64) ? ((1ULL << (y % 64)) - 1) : 0;
+
+		column->dirty[w] &= mask;
+		column->boundary[w] &= mask;
+	}
+}
+
+PMATRIX CreateMatrix (
+	_In_ ULONG numcols,
+	_In_ ULONG numrows,
+	_In_ ULONG64 seed
+)
+{
+	PMATRIX matrix;
+
+	matrix = AllocateMatrix (numcols, numrows);
+
+	if (!matrix)
+		return NULL;
+
+	matrix->seed = seed;
+
+	for (ULONG x = 0; x < numcols; x++)
+		ResetMatrixColumn (matrix, x);
+
+	return matrix;
+}
+
+BOOLEAN ResizeMatrix (
+	_Inout_ PMATRIX *matrix,
+	_In_ ULONG numcols,
+	_In_ ULONG numrows
+)
+{
+	PMATRIX_COLUMN column;
+	PMATRIX current;
+	PMATRIX resized;
+	ULONG cols;
+	ULONG rows;
+
+	current = *matrix;
+
+	if (!numcols || !numrows)
+		return FALSE;
+
+	cols = (current->numcols < numcols) ? current->numcols : numcols;
+	rows = (current->numrows < numrows) ? current->numrows : numrows;
+
+	// sleeping columns counted on the old length
+	WakeMatrix (current);
+
+	if (numcols <= current->column_capacity && numrows + MATRIX_PADDING <= current->stride && numrows <= current->dirty_stride * 64)
+	{
+		// dropped columns are cleared, so they can come back blank
+		for (ULONG x = numcols; x < current->numcols; x++)
+		{
+			TrimMatrixColumn (current, &current->column[x], 0);
+
+			current->dirty_columns[x / 64] &= ~(1ULL << (x % 64));
+			current->active_columns[x / 64] &= ~(1ULL << (x % 64));
+		}
+
+		current->numrows = numrows;
+
+		for (ULONG x = 0; x < cols; x++)
+		{
+			column = &current->column[x];
+
+			if (numrows < column->length)
+				TrimMatrixColumn (current, column, numrows);
+
+			column->length = numrows;
+
+			TrimMatrixBlip (column);
+
+			// the first new row can start a boundary against the last old one
+			UpdateBoundary (column, rows - 1);
+		}
+
+		current->numcols = numcols;
+
+		for (ULONG x = cols; x < numcols; x++)
+			ResetMatrixColumn (current, x);
+
+		return TRUE;
+	}
+
+	// does not fit, move the live state into a block laid out for the new size
+	resized = AllocateMatrix (numcols, numrows);
+
+	if (!resized)
+		return FALSE;
+
+	resized->seed = current->seed;
+	resized->amount = current->amount;
+	resized->density = current->density;
+	resized->step = current->step;
+
+	for (ULONG x = 0; x < cols; x++)
+	{
+		column = &resized->column[x];
+
+		column->random = current->column[x].random;
+		column->run_length = current->column[x].run_length;
+		column->blip_length = current->column[x].blip_length;
+		column->blip_pos = current->column[x].blip_pos;
+		column->state = current->column[x].state;
+		column->countdown = current->column[x].countdown;
+		column->is_started = current->column[x].is_started;
+
+		column->length = numrows;
+
+		TrimMatrixBlip (column);
+
+		resized->active_columns[x / 64] |= 1ULL << (x % 64);
+
+		RtlCopyMemory (column->glyph, current->column[x].glyph, sizeof (GLYPH) * rows);
+
+		for (ULONG_PTR y = 0; y < rows; y++)
+		{
+			if (current->column[x].dirty[y / 64] & (1ULL << (y % 64)))
+				MarkGlyph (resized, column, y);
+
+			UpdateBoundary (column, y);
+		}
+	}
+
+	for (ULONG x = cols; x < numcols; x++)
+		ResetMatrixColumn (resized, x);
+
+	DestroyMatrix (&current);
+
+	*matrix = resized;
+
+	return TRUE;
+}
+
+VOID InvalidateMatrix (
+	_Inout_ PMATRIX matrix
+)
+{
+	PMATRIX_COLUMN column;
+
+	for (ULONG x = 0; x < matrix->numcols; x++)
+	{
+		column = &matrix->column[x];
+
+		// blank cells are black in a cleared frame buffer anyway
+		for (ULONG_PTR y = 0; y < column->length; y++)
+		{
+			if (column->glyph[y])
+				MarkGlyph (matrix, column, y);
+		}
+	}
+}
+
+SIZE_T GetMatrixSnapshotSize (
+	_In_ PMATRIX matrix
+)
+{
+	SIZE_T size;
+
+	size = sizeof (MATRIX_SNAPSHOT_HEADER);
+	size += sizeof (MATRIX_SNAPSHOT_COLUMN) * (SIZE_T)matrix->numcols;
+	size += sizeof (GLYPH) * (SIZE_T)matrix->numcols * matrix->numrows;
+
+	return size;
+}
+
+BOOLEAN SaveMatrixSnapshot (
+	_In_ PMATRIX matrix,
+	_Out_writes_bytes_ (size) PVOID buffer,
+	_In_ SIZE_T size
+)
+{
+	PMATRIX_SNAPSHOT_HEADER header;
+	PMATRIX_SNAPSHOT_COLUMN record;
+	MATRIX_COLUMN column;
+	PGLYPH glyphs;
+
+	if (size < GetMatrixSnapshotSize (matrix))
+		return FALSE;
+
+	header = buffer;
+
+	header->magic = MATRIX_SNAPSHOT_MAGIC;
+	header->version = MATRIX_SNAPSHOT_VERSION;
+	header->numcols = matrix->numcols;
+	header->numrows = matrix->numrows;
+	header->amount = matrix->amount;
+	header->density = matrix->density;
+	header->seed = matrix->seed;
+
+	record = (PMATRIX_SNAPSHOT_COLUMN)(header + 1);
+	glyphs = (PGLYPH)(record + matrix->numcols);
+
+	for (ULONG x = 0; x < matrix->numcols; x++)
+	{
+		column = matrix->column[x];
+
+		// a sleeping column is stored as if it had been updated every step
+		if (column.wake_step)
+			CatchUpMatrixColumn (&column, (ULONG_PTR)(matrix->step - column.sleep_step));
+
+		RtlCopyMemory (record->random, column.random.s, sizeof (record->random));
+
+		record->run_length = (ULONG)column.run_length;
+		record->blip_length = (ULONG)column.blip_length;
+		record->blip_pos = (ULONG)column.blip_pos;
+		record->state = column.state;
+		record->countdown = column.countdown;
+		record->is_started = column.is_started;
+
+		RtlCopyMemory (glyphs, column.glyph, sizeof (GLYPH) * matrix->numrows);
+
+		record += 1;
+		glyphs += matrix->numrows;
+	}
+
+	return TRUE;
+}
+
+// intensity 0 to MAX_INTENSITY - 1 and a glyph of the atlas, the blip
+// intensity is only added when drawing
+FORCEINLINE BOOLEAN IsSnapshotGlyphValid (
+	_In_ GLYPH glyph
+)
+{
+	// the amount can have been lowered since these were drawn
+	return (glyph >> 8) < MAX_INTENSITY && GlyphIndex (glyph) < AMOUNT_MAX;
+}
+
+static BOOLEAN IsSnapshotColumnValid (
+	_In_ PMATRIX_SNAPSHOT_COLUMN record,
+	_In_ ULONG numrows
+)
+{
+	// an all zero xoshiro state would stay zero
+	if (!(record->random[0] | record->random[1] | record->random[2] | record->random[3]))
+		return FALSE;
+
+	if (record->state != 0 && record->state != 1)
+		return FALSE;
+
+	if (!record->run_length || record->run_length > MATRIX_RUN_MAX)
+		return FALSE;
+
+	if (record->blip_length > numrows + MATRIX_BLIP_RESTART - 1 || record->blip_pos > record->blip_length)
+		return FALSE;
+
+	return TRUE;
+}
+
+PMATRIX RestoreMatrix (
+	_In_reads_bytes_ (size) CONST VOID *buffer,
+	_In_ SIZE_T size,
+	_In_ ULONG numcols,
+	_In_ ULONG numrows
+)
+{
+	MATRIX_SNAPSHOT_HEADER header;
+	MATRIX_SNAPSHOT_COLUMN record;
+	CONST UCHAR *records;
+	CONST UCHAR *glyphs;
+	PMATRIX_COLUMN column;
+	PMATRIX matrix;
+	GLYPH glyph;
+	ULONG cols;
+	ULONG rows;
+
+	if (size < sizeof (header))
+		return NULL;
+
+	RtlCopyMemory (&header, buffer, sizeof (header));
+
+	if (header.magic != MATRIX_SNAPSHOT_MAGIC || header.version != MATRIX_SNAPSHOT_VERSION)
+		return NULL;
+
+	// a damaged header must not make us read past the buffer
+	if (!header.numcols || header.numcols > 0x10000 || header.numrows > 0x10000)
+		return NULL;
+
+	if (size != sizeof (header) + (sizeof (record) * (SIZE_T)header.numcols) + (sizeof (GLYPH) * (SIZE_T)header.numcols * header.numrows))
+		return NULL;
+
+	records = (CONST UCHAR *)buffer + sizeof (header);
+	glyphs = records + (sizeof (record) * header.numcols);
+
+	// a stale or damaged file is refused as a whole, the atlas is indexed
+	// by the glyphs and the columns have to be in a state the update keeps
+	for (ULONG x = 0; x < header.numcols; x++)
+	{
+		RtlCopyMemory (&record, records + (sizeof (record) * x), sizeof (record));
+
+		if (!IsSnapshotColumnValid (&record, header.numrows))
+			return NULL;
+	}
+
+	for (SIZE_T i = 0; i < (SIZE_T)header.numcols * header.numrows; i++)
+	{
+		RtlCopyMemory (&glyph, glyphs + (sizeof (GLYPH) * i), sizeof (GLYPH));
+
+		if (!IsSnapshotGlyphValid (glyph))
+			return NULL;
+	}
+
+	matrix = CreateMatrix (numcols, numrows, header.seed);
+
+	if (!matrix)
+		return NULL;
+
+	if (header.amount >= AMOUNT_MIN && header.amount <= AMOUNT_MAX)
+		matrix->amount = header.amount;
+
+	if (header.density >= DENSITY_MIN && header.density <= DENSITY_MAX)
+		matrix->density = header.density;
+
+	cols = (header.numcols < numcols) ? header.numcols : numcols;
+	rows = (header.numrows < numrows) ? header.numrows : numrows;
+
+	for (ULONG x = 0; x < cols; x++)
+	{
+		column = &matrix->column[x];
+
+		RtlCopyMemory (&record, records + (sizeof (record) * x), sizeof (record));
+
+		RtlCopyMemory (column->random.s, record.random, sizeof (record.random));
+
+		column->run_length = record.run_length;
+		column->blip_length = record.blip_length;
+		column->blip_pos = record.blip_pos;
+		column->state = record.state;
+		column->countdown = record.countdown;
+		column->is_started = record.is_started ? TRUE : FALSE;
+
+		// the snapshot can have more rows than the grid
+		TrimMatrixBlip (column);
+
+		RtlCopyMemory (column->glyph, glyphs + (sizeof (GLYPH) * (SIZE_T)header.numrows * x), sizeof (GLYPH) * rows);
+
+		for (ULONG_PTR y = 0; y < rows; y++)
+			UpdateBoundary (column, y);
+	}
+
+	// draw the whole grid on the first frame
+	InvalidateMatrix (matrix);
+
+	return matrix;
+}
+
+VOID ReseedMatrix (
+	_Inout_ PMATRIX matrix,
+	_In_ ULONG64 seed
+)
+{
+	// draws owed by sleeping columns come from the old streams
+	WakeMatrix (matrix);
+
+	matrix->seed = seed;
+
+	for (ULONG x = 0; x < matrix->numcols; x++)
+		RandomSeed (&matrix->column[x].random, seed, x);
+}
+
+ULONG64 HashMatrix (
+	_In_ PMATRIX matrix
+)
+{
+	PMATRIX_COLUMN column;
+	ULONG64 hash;
+
+	hash = PlatformHash64 (PLATFORM_HASH_BASIS, matrix->numcols);
+	hash = PlatformHash64 (hash, matrix->numrows);
+
+	for (ULONG x = 0; x < matrix->numcols; x++)
+	{
+		column = &matrix->column[x];
+
+		for (ULONG y = 0; y < matrix->numrows; y++)
+			hash = PlatformHash64 (hash, column->glyph[y]);
+	}
+
+	return hash;
+}
+
+BOOLEAN FindMatrixDifference (
+	_In_ PMATRIX matrix,
+	_In_ PMATRIX other,
+	_Out_ PULONG x,
+	_Out_ PULONG y
+)
+{
+	*x = 0;
+	*y = 0;
+
+	if (matrix->numcols != other->numcols || matrix->numrows != other->numrows)
+		return TRUE;
+
+	for (ULONG i = 0; i < matrix->numcols; i++)
+	{
+		for (ULONG j = 0; j < matrix->numrows; j++)
+		{
+			if (matrix->column[i].glyph[j] != other->column[i].glyph[j])
+			{
+				*x = i;
+				*y = j;
+
+				return TRUE;
+			}
+		}
+	}
+
+	return FALSE;
+}
+
+VOID DestroyMatrix (
+	_Inout_ PMATRIX *matrix
+)
+{
+	PMATRIX old_matrix;
+
+	old_matrix = *matrix;
+	*matrix = NULL;
+
+	if (!MatrixPoolRelease (old_matrix))
+		PlatformFreeAligned (old_matrix);
+}
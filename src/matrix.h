@@ -0,0 +1,267 @@
+// Matrix Screensaver
+// Copyright (c) J Brown 2003 (catch22.net)
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+#include "random.h"
+#include "worker.h"
+
+#define GLYPH_BLANK 0x4000
+#define RND_MASK 0xB400
+
+#define AMOUNT_MIN 1
+#define AMOUNT_MAX 26
+#define AMOUNT_DEFAULT 26
+
+#define DENSITY_MIN 5
+#define DENSITY_MAX 50
+#define DENSITY_DEFAULT 30
+
+// grid storage
+#define MATRIX_ALIGNMENT 64 // cache line
+#define MATRIX_PADDING 16 // rows past the end of a column, blips are marked there
+#define MATRIX_BLIP_RESTART 50 // a blip restarts within this many rows past the end
+#define MATRIX_RUN_MAX (3 * DENSITY_MAX / 2 + DENSITY_MIN) // longest run or gap, in steps
+#define MATRIX_POOL_SIZE 4 // released matrices kept for reuse
+
+// parallel update
+#define MATRIX_BLOCK_COLUMNS 64 // one word of dirty_columns, blocks never share it
+#define MATRIX_PARALLEL_COLUMNS 256 // crossover, narrower grids are cheaper on one thread
+
+// snapshot format
+#define MATRIX_SNAPSHOT_MAGIC 0x5852544D // "MTRX"
+#define MATRIX_SNAPSHOT_VERSION 1
+
+// constants inferred from matrix.bmp
+#define MAX_INTENSITY 5 // number of intensity levels
+#define GLYPH_WIDTH 14 // width of each glyph (pixels)
+#define GLYPH_HEIGHT 14 // height of each glyph (pixels)
+
+// glyph index in bits 0-7, intensity in bits 8-14, redraw state is kept
+// in the dirty bitmaps, so a cell fits 16 bits
+typedef USHORT GLYPH;
+typedef PUSHORT PGLYPH;
+
+//	The "matrix" is basically an array of these
+//  column structures, positioned side-by-side
+typedef struct _MATRIX_COLUMN
+{
+	PGLYPH glyph;
+
+	// one bit per row, set when the glyph has to be redrawn
+	PULONG64 dirty;
+
+	// one bit per row whose intensity differs from the row above, these
+	// are the heads and tails of the runs. row 0 never has a bit.
+	PULONG64 boundary;
+
+	RANDOM_STATE random;
+
+	ULONG_PTR run_length;
+	ULONG_PTR length;
+
+	ULONG_PTR blip_length;
+	ULONG_PTR blip_pos;
+
+	LONG state;
+	LONG countdown;
+
+	// a sleeping column was last updated at sleep_step and is updated
+	// again at wake_step, it is awake when wake_step is zero
+	ULONG64 sleep_step;
+	ULONG64 wake_step;
+
+	BOOLEAN is_started;
+} MATRIX_COLUMN, *PMATRIX_COLUMN;
+
+// simulation state only, drawing is done by the caller through
+// the redraw callback, so it does not depend on any platform api.
+//
+// the header, columns, glyphs and bitmaps are one aligned block,
+// glyphs of a column start at column[x].glyph and the next column
+// follows it after stride glyphs.
+typedef struct _MATRIX
+{
+	ULONG64 seed;
+
+	PGLYPH cells;
+	SIZE_T size;
+	ULONG stride;
+
+	// one bit per column that has dirty rows
+	PULONG64 dirty_columns;
+	ULONG dirty_stride;
+
+	// one bit per column that is updated on every step, the others sleep
+	// in the timer heap ordered by wake_step. columns falling asleep are
+	// set in sleeping_columns by the workers and queued after the step,
+	// the ones asleep in the blank state still move their blip.
+	PULONG64 active_columns;
+	PULONG64 sleeping_columns;
+	PULONG64 blank_columns;
+	PULONG timers;
+	ULONG timer_count;
+
+	ULONG64 step;
+
+	LONG amount;
+	LONG density;
+
+	ULONG numcols;
+	ULONG numrows;
+
+	// columns the block was laid out for, a resize stays in place up to it
+	ULONG column_capacity;
+
+	MATRIX_COLUMN column[1];
+} MATRIX, *PMATRIX;
+
+//
+// snapshot layout, native byte order: the header, one record per column
+// and then numrows glyphs per column. redraw and run boundary bits are
+// not stored, they are rebuilt on restore.
+//
+typedef struct _MATRIX_SNAPSHOT_HEADER
+{
+	ULONG magic;
+	ULONG version;
+
+	ULONG numcols;
+	ULONG numrows;
+
+	LONG amount;
+	LONG density;
+
+	ULONG64 seed;
+} MATRIX_SNAPSHOT_HEADER, *PMATRIX_SNAPSHOT_HEADER;
+
+typedef struct _MATRIX_SNAPSHOT_COLUMN
+{
+	ULONG random[4];
+
+	ULONG run_length;
+	ULONG blip_length;
+	ULONG blip_pos;
+
+	LONG state;
+	LONG countdown;
+
+	ULONG is_started;
+} MATRIX_SNAPSHOT_COLUMN, *PMATRIX_SNAPSHOT_COLUMN;
+
+typedef VOID (*PMATRIX_DRAW_CALLBACK) (
+	_In_opt_ PVOID context,
+	_In_ ULONG x,
+	_In_ ULONG y,
+	_In_ GLYPH glyph
+);
+
+FORCEINLINE GLYPH GlyphIntensity (
+	_In_ GLYPH glyph
+)
+{
+	return (GLYPH)((glyph & 0x7F00) >> 8);
+}
+
+FORCEINLINE ULONG GlyphIndex (
+	_In_ GLYPH glyph
+)
+{
+	return glyph & 0xFF;
+}
+
+PMATRIX CreateMatrix (
+	_In_ ULONG numcols,
+	_In_ ULONG numrows,
+	_In_ ULONG64 seed
+);
+
+VOID DestroyMatrix (
+	_Inout_ PMATRIX *matrix
+);
+
+VOID UpdateMatrix (
+	_Inout_ PMATRIX matrix
+);
+
+// same result as UpdateMatrix, columns are shared between the pool workers
+VOID UpdateMatrixParallel (
+	_Inout_ PMATRIX matrix,
+	_In_opt_ PWORKER_POOL pool
+);
+
+ULONG RedrawMatrix (
+	_Inout_ PMATRIX matrix,
+	_In_ PMATRIX_DRAW_CALLBACK callback,
+	_In_opt_ PVOID context
+);
+
+// columns updated by the next step, sleeping ones are not counted
+ULONG GetMatrixActiveColumns (
+	_In_ PMATRIX matrix
+);
+
+VOID FlushMatrixPool ();
+
+// blocks taken from the heap, pool hits are not counted
+ULONG64 GetMatrixAllocationCount ();
+
+SIZE_T GetMatrixSnapshotSize (
+	_In_ PMATRIX matrix
+);
+
+BOOLEAN SaveMatrixSnapshot (
+	_In_ PMATRIX matrix,
+	_Out_writes_bytes_ (size) PVOID buffer,
+	_In_ SIZE_T size
+);
+
+// the grid is cropped or padded to numcols x numrows, padding columns
+// start like new ones. returns NULL if the snapshot is not valid, also
+// when a cell or column holds a value the simulation never produces.
+PMATRIX RestoreMatrix (
+	_In_reads_bytes_ (size) CONST VOID *buffer,
+	_In_ SIZE_T size,
+	_In_ ULONG numcols,
+	_In_ ULONG numrows
+);
+
+//
+// keeps the live columns and rows, new columns start like fresh ones and
+// new rows are blank. stays in the same block when the rows fit its
+// stride and the columns its capacity, the pointer can change otherwise.
+// the old matrix is untouched when it returns FALSE.
+//
+BOOLEAN ResizeMatrix (
+	_Inout_ PMATRIX *matrix,
+	_In_ ULONG numcols,
+	_In_ ULONG numrows
+);
+
+// marks every visible glyph, for a caller that lost its frame buffer
+VOID InvalidateMatrix (
+	_Inout_ PMATRIX matrix
+);
+
+// new random streams, the state on screen is kept
+VOID ReseedMatrix (
+	_Inout_ PMATRIX matrix,
+	_In_ ULONG64 seed
+);
+
+// hash of the size and the glyphs on screen, the same on every platform
+ULONG64 HashMatrix (
+	_In_ PMATRIX matrix
+);
+
+// first cell, column by column, whose glyph differs. grids of different
+// sizes differ at 0, 0. returns FALSE when they are the same.
+BOOLEAN FindMatrixDifference (
+	_In_ PMATRIX matrix,
+	_In_ PMATRIX other,
+	_Out_ PULONG x,
+	_Out_ PULONG y
+);
@@ -0,0 +1,253 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+#include <unistd.h>
+#endif // !_WIN32
+
+#include "platform.h"
+
+ULONG64 PlatformQueryNanoseconds ()
+{
+#if defined(_WIN32)
+	static LARGE_INTEGER frequency = {0};
+	LARGE_INTEGER counter;
+
+	if (!frequency.QuadPart)
+		QueryPerformanceFrequency (&frequency);
+
+	QueryPerformanceCounter (&counter);
+
+	// split the multiplication, so it does not overflow after minutes
+	return ((ULONG64)(counter.QuadPart / frequency.QuadPart) * 1000000000ULL) +
+		((ULONG64)(counter.QuadPart % frequency.QuadPart) * 1000000000ULL / frequency.QuadPart);
+#else
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+
+	return ((ULONG64)ts.tv_sec * 1000000000ULL) + (ULONG64)ts.tv_nsec;
+#endif // _WIN32
+}
+
+ULONG PlatformGetProcessorCount ()
+{
+	LONG count;
+
+#if defined(_WIN32)
+	count = (LONG)GetActiveProcessorCount (ALL_PROCESSOR_GROUPS);
+#else
+	count = (LONG)sysconf (_SC_NPROCESSORS_ONLN);
+#endif // _WIN32
+
+	return count > 0 ? (ULONG)count : 1;
+}
+
+VOID PlatformSleep (
+	_In_ ULONG64 nanoseconds
+)
+{
+#if defined(_WIN32)
+	Sleep ((DWORD)((nanoseconds + 999999) / 1000000));
+#else
+	struct timespec ts;
+
+	ts.tv_sec = (time_t)(nanoseconds / 1000000000ULL);
+	ts.tv_nsec = (long)(nanoseconds % 1000000000ULL);
+
+	nanosleep (&ts, NULL);
+#endif // _WIN32
+}
+
+typedef struct _PLATFORM_THREAD_START
+{
+	PPLATFORM_THREAD_ROUTINE routine;
+	PVOID context;
+} PLATFORM_THREAD_START, *PPLATFORM_THREAD_START;
+
+#if defined(_WIN32)
+static DWORD WINAPI PlatformThreadStart (
+	_In_ LPVOID parameter
+)
+#else
+static PVOID PlatformThreadStart (
+	_In_ PVOID parameter
+)
+#endif // _WIN32
+{
+	PLATFORM_THREAD_START start;
+
+	start = *(PPLATFORM_THREAD_START)parameter;
+
+	free (parameter);
+
+	start.routine (start.context);
+
+	return 0;
+}
+
+BOOLEAN PlatformCreateThread (
+	_Out_ PLATFORM_THREAD *thread,
+	_In_ PPLATFORM_THREAD_ROUTINE routine,
+	_In_opt_ PVOID context
+)
+{
+	PPLATFORM_THREAD_START start;
+
+	start = malloc (sizeof (PLATFORM_THREAD_START));
+
+	if (!start)
+		return FALSE;
+
+	start->routine = routine;
+	start->context = context;
+
+#if defined(_WIN32)
+	*thread = CreateThread (NULL, 0, &PlatformThreadStart, start, 0, NULL);
+
+	if (*thread)
+		return TRUE;
+#else
+	if (pthread_create (thread, NULL, &PlatformThreadStart, start) == 0)
+		return TRUE;
+#endif // _WIN32
+
+	free (start);
+
+	return FALSE;
+}
+
+VOID PlatformJoinThread (
+	_In_ PLATFORM_THREAD thread
+)
+{
+#if defined(_WIN32)
+	WaitForSingleObject (thread, INFINITE);
+	CloseHandle (thread);
+#else
+	pthread_join (thread, NULL);
+#endif // _WIN32
+}
+
+VOID PlatformInitializeLock (
+	_Out_ PLATFORM_LOCK *lock
+)
+{
+#if defined(_WIN32)
+	InitializeSRWLock (lock);
+#else
+	pthread_mutex_init (lock, NULL);
+#endif // _WIN32
+}
+
+VOID PlatformDeleteLock (
+	_Inout_ PLATFORM_LOCK *lock
+)
+{
+#if defined(_WIN32)
+	// slim locks have nothing to free
+	(VOID)lock;
+#else
+	pthread_mutex_destroy (lock);
+#endif // _WIN32
+}
+
+VOID PlatformAcquireLock (
+	_Inout_ PLATFORM_LOCK *lock
+)
+{
+#if defined(_WIN32)
+	AcquireSRWLockExclusive (lock);
+#else
+	pthread_mutex_lock (lock);
+#endif // _WIN32
+}
+
+VOID PlatformReleaseLock (
+	_Inout_ PLATFORM_LOCK *lock
+)
+{
+#if defined(_WIN32)
+	ReleaseSRWLockExclusive (lock);
+#else
+	pthread_mutex_unlock (lock);
+#endif // _WIN32
+}
+
+VOID PlatformInitializeCondition (
+	_Out_ PLATFORM_CONDITION *condition
+)
+{
+#if defined(_WIN32)
+	InitializeConditionVariable (condition);
+#else
+	pthread_cond_init (condition, NULL);
+#endif // _WIN32
+}
+
+VOID PlatformDeleteCondition (
+	_Inout_ PLATFORM_CONDITION *condition
+)
+{
+#if defined(_WIN32)
+	(VOID)condition;
+#else
+	pthread_cond_destroy (condition);
+#endif // _WIN32
+}
+
+VOID PlatformWaitCondition (
+	_Inout_ PLATFORM_CONDITION *condition,
+	_Inout_ PLATFORM_LOCK *lock
+)
+{
+#if defined(_WIN32)
+	SleepConditionVariableSRW (condition, lock, INFINITE, 0);
+#else
+	pthread_cond_wait (condition, lock);
+#endif // _WIN32
+}
+
+VOID PlatformWaitConditionTimeout (
+	_Inout_ PLATFORM_CONDITION *condition,
+	_Inout_ PLATFORM_LOCK *lock,
+	_In_ ULONG64 nanoseconds
+)
+{
+#if defined(_WIN32)
+	ULONG64 milliseconds;
+
+	// round up, a zero wait would spin
+	milliseconds = (nanoseconds + 999999) / 1000000;
+
+	if (milliseconds >= INFINITE)
+		milliseconds = INFINITE - 1;
+
+	SleepConditionVariableSRW (condition, lock, (DWORD)milliseconds, 0);
+#else
+	struct timespec ts;
+
+	// condition variables wait on the realtime clock by default
+	clock_gettime (CLOCK_REALTIME, &ts);
+
+	nanoseconds += (ULONG64)ts.tv_nsec;
+
+	ts.tv_sec += (time_t)(nanoseconds / 1000000000ULL);
+	ts.tv_nsec = (long)(nanoseconds % 1000000000ULL);
+
+	pthread_cond_timedwait (condition, lock, &ts);
+#endif // _WIN32
+}
+
+VOID PlatformWakeAllCondition (
+	_Inout_ PLATFORM_CONDITION *condition
+)
+{
+#if defined(_WIN32)
+	WakeAllConditionVariable (condition);
+#else
+	pthread_cond_broadcast (condition);
+#endif // _WIN32
+}
@@ -0,0 +1,288 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+// portable parts of the screensaver (simulation, atlas, compositor) are
+// written against this header only, so they can be built without windows sdk.
+
+#if defined(_WIN32)
+
+#include <windows.h>
+#include <malloc.h>
+
+typedef SRWLOCK PLATFORM_LOCK;
+typedef CONDITION_VARIABLE PLATFORM_CONDITION;
+typedef HANDLE PLATFORM_THREAD;
+
+#else
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VOID void
+#define CONST const
+
+#define TRUE 1
+#define FALSE 0
+
+#define FORCEINLINE static inline __attribute__((always_inline))
+#define RTL_NUMBER_OF(a) (sizeof (a) / sizeof ((a)[0]))
+
+#define RtlCopyMemory(dst, src, length) memcpy ((dst), (src), (length))
+#define RtlMoveMemory(dst, src, length) memmove ((dst), (src), (length))
+#define RtlZeroMemory(dst, length) memset ((dst), 0, (length))
+#define RtlFillMemory(dst, length, fill) memset ((dst), (fill), (length))
+
+typedef void *PVOID;
+
+typedef char CHAR, *PSTR;
+typedef const char *PCSTR;
+
+typedef uint8_t UCHAR, *PUCHAR;
+typedef uint8_t BYTE, *PBYTE;
+typedef uint8_t BOOLEAN, *PBOOLEAN;
+typedef uint16_t USHORT, *PUSHORT;
+typedef uint16_t WORD, *PWORD;
+typedef int32_t LONG, *PLONG;
+typedef uint32_t ULONG, *PULONG;
+typedef int32_t INT, *PINT;
+typedef uint32_t UINT, *PUINT;
+typedef int64_t LONG64, *PLONG64;
+typedef uint64_t ULONG64, *PULONG64;
+typedef uintptr_t ULONG_PTR, *PULONG_PTR;
+typedef intptr_t LONG_PTR, *PLONG_PTR;
+typedef size_t SIZE_T, *PSIZE_T;
+typedef uint32_t COLORREF;
+
+typedef pthread_mutex_t PLATFORM_LOCK;
+typedef pthread_cond_t PLATFORM_CONDITION;
+typedef pthread_t PLATFORM_THREAD;
+
+// sal annotations
+#define _In_
+#define _In_opt_
+#define _Out_
+#define _Out_opt_
+#define _Inout_
+#define _Inout_opt_
+#define _In_reads_(size)
+#define _Out_writes_(size)
+#define _Inout_updates_(size)
+#define _In_reads_bytes_(size)
+#define _Out_writes_bytes_(size)
+
+#endif // _WIN32
+
+#define PLATFORM_ALIGN_UP(value, alignment) (((value) + ((alignment) - 1)) & ~((SIZE_T)(alignment) - 1))
+
+// alignment must be a power of two
+FORCEINLINE PVOID PlatformAllocateAligned (
+	_In_ SIZE_T size,
+	_In_ SIZE_T alignment
+)
+{
+#if defined(_WIN32)
+	return _aligned_malloc (size, alignment);
+#else
+	// c11 aligned_alloc wants size to be a multiple of alignment
+	return aligned_alloc (alignment, PLATFORM_ALIGN_UP (size, alignment));
+#endif // _WIN32
+}
+
+FORCEINLINE VOID PlatformFreeAligned (
+	_In_ PVOID memory
+)
+{
+#if defined(_WIN32)
+	_aligned_free (memory);
+#else
+	free (memory);
+#endif // _WIN32
+}
+
+// index of the lowest set bit, value must not be zero
+FORCEINLINE ULONG PlatformCountTrailingZeros64 (
+	_In_ ULONG64 value
+)
+{
+#if defined(_M_IX86)
+	ULONG index;
+
+	// there is no 64-bit scan on x86, try the low half first
+	if (_BitScanForward (&index, (ULONG)value))
+		return index;
+
+	_BitScanForward (&index, (ULONG)(value >> 32));
+
+	return index + 32;
+#elif defined(_WIN32)
+	ULONG index;
+
+	_BitScanForward64 (&index, value);
+
+	return index;
+#else
+	return (ULONG)__builtin_ctzll (value);
+#endif // _WIN32
+}
+
+// index of the highest set bit, value must not be zero
+FORCEINLINE ULONG PlatformFindHighestBit64 (
+	_In_ ULONG64 value
+)
+{
+#if defined(_M_IX86)
+	ULONG index;
+
+	// there is no 64-bit scan on x86, try the high half first
+	if (_BitScanReverse (&index, (ULONG)(value >> 32)))
+		return index + 32;
+
+	_BitScanReverse (&index, (ULONG)value);
+
+	return index;
+#elif defined(_WIN32)
+	ULONG index;
+
+	_BitScanReverse64 (&index, value);
+
+	return index;
+#else
+	return 63 - (ULONG)__builtin_clzll (value);
+#endif // _WIN32
+}
+
+FORCEINLINE ULONG PlatformPopulationCount64 (
+	_In_ ULONG64 value
+)
+{
+#if defined(_WIN32)
+	// popcnt is not in the x64 baseline, count the bits by hand
+	value = value - ((value >> 1) & 0x5555555555555555ULL);
+	value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+	return (ULONG)((value * 0x0101010101010101ULL) >> 56);
+#else
+	return (ULONG)__builtin_popcountll (value);
+#endif // _WIN32
+}
+
+#define PLATFORM_HASH_BASIS 0xCBF29CE484222325ULL // fnv-1a 64
+
+// fnv-1a step over a whole value instead of a byte, it does not depend on byte order
+FORCEINLINE ULONG64 PlatformHash64 (
+	_In_ ULONG64 hash,
+	_In_ ULONG64 value
+)
+{
+	return (hash ^ value) * 0x100000001B3ULL;
+}
+
+// monotonic clock
+ULONG64 PlatformQueryNanoseconds ();
+
+FORCEINLINE LONG PlatformInterlockedExchangeAdd (
+	_Inout_ volatile LONG *target,
+	_In_ LONG value
+)
+{
+#if defined(_WIN32)
+	return InterlockedExchangeAdd (target, value);
+#else
+	return __atomic_fetch_add (target, value, __ATOMIC_ACQ_REL);
+#endif // _WIN32
+}
+
+// publishes a pointer to other threads, whatever was written before
+// is seen by a thread that loads it with PlatformLoadPointerAcquire
+FORCEINLINE VOID PlatformStorePointerRelease (
+	_Inout_ PVOID volatile *target,
+	_In_opt_ PVOID value
+)
+{
+#if defined(_WIN32)
+	InterlockedExchangePointer (target, value);
+#else
+	__atomic_store_n (target, value, __ATOMIC_RELEASE);
+#endif // _WIN32
+}
+
+FORCEINLINE PVOID PlatformLoadPointerAcquire (
+	_In_ PVOID volatile *source
+)
+{
+#if defined(_WIN32)
+	return InterlockedCompareExchangePointer (source, NULL, NULL);
+#else
+	return __atomic_load_n (source, __ATOMIC_ACQUIRE);
+#endif // _WIN32
+}
+
+ULONG PlatformGetProcessorCount ();
+
+VOID PlatformSleep (
+	_In_ ULONG64 nanoseconds
+);
+
+//
+// threads and synchronization
+//
+typedef VOID (*PPLATFORM_THREAD_ROUTINE) (
+	_In_opt_ PVOID context
+);
+
+BOOLEAN PlatformCreateThread (
+	_Out_ PLATFORM_THREAD *thread,
+	_In_ PPLATFORM_THREAD_ROUTINE routine,
+	_In_opt_ PVOID context
+);
+
+VOID PlatformJoinThread (
+	_In_ PLATFORM_THREAD thread
+);
+
+VOID PlatformInitializeLock (
+	_Out_ PLATFORM_LOCK *lock
+);
+
+VOID PlatformDeleteLock (
+	_Inout_ PLATFORM_LOCK *lock
+);
+
+VOID PlatformAcquireLock (
+	_Inout_ PLATFORM_LOCK *lock
+);
+
+VOID PlatformReleaseLock (
+	_Inout_ PLATFORM_LOCK *lock
+);
+
+VOID PlatformInitializeCondition (
+	_Out_ PLATFORM_CONDITION *condition
+);
+
+VOID PlatformDeleteCondition (
+	_Inout_ PLATFORM_CONDITION *condition
+);
+
+// lock must be held, it is released while waiting
+VOID PlatformWaitCondition (
+	_Inout_ PLATFORM_CONDITION *condition,
+	_Inout_ PLATFORM_LOCK *lock
+);
+
+// returns after a wake or once the timeout has passed, whichever is first
+VOID PlatformWaitConditionTimeout (
+	_Inout_ PLATFORM_CONDITION *condition,
+	_Inout_ PLATFORM_LOCK *lock,
+	_In_ ULONG64 nanoseconds
+);
+
+VOID PlatformWakeAllCondition (
+	_Inout_ PLATFORM_CONDITION *condition
+);
@@ -0,0 +1,141 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+//
+// xoshiro128++ generator. every column owns a stream derived from
+// the matrix seed and the column index, so the output does not depend
+// on the order columns are processed in.
+//
+typedef struct _RANDOM_STATE
+{
+	ULONG s[4];
+} RANDOM_STATE, *PRANDOM_STATE;
+
+FORCEINLINE ULONG64 RandomSplitMix64 (
+	_Inout_ PULONG64 x
+)
+{
+	ULONG64 z;
+
+	z = (*x += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+FORCEINLINE VOID RandomSeed (
+	_Out_ PRANDOM_STATE state,
+	_In_ ULONG64 seed,
+	_In_ ULONG64 stream
+)
+{
+	ULONG64 x;
+	ULONG64 value;
+
+	// decorrelate neighbouring streams before expanding them
+	x = seed;
+	x = RandomSplitMix64 (&x) ^ stream;
+
+	value = RandomSplitMix64 (&x);
+
+	state->s[0] = (ULONG)value;
+	state->s[1] = (ULONG)(value >> 32);
+
+	value = RandomSplitMix64 (&x);
+
+	state->s[2] = (ULONG)value;
+	state->s[3] = (ULONG)(value >> 32);
+
+	// all-zero state is the only one that never leaves zero
+	if (!(state->s[0] | state->s[1] | state->s[2] | state->s[3]))
+		state->s[0] = 1;
+}
+
+FORCEINLINE ULONG RandomRotate (
+	_In_ ULONG x,
+	_In_ INT k
+)
+{
+	return (x << k) | (x >> (32 - k));
+}
+
+FORCEINLINE ULONG RandomNext (
+	_Inout_ PRANDOM_STATE state
+)
+{
+	ULONG result;
+	ULONG t;
+
+	result = RandomRotate (state->s[0] + state->s[3], 7) + state->s[0];
+
+	t = state->s[1] << 9;
+
+	state->s[2] ^= state->s[0];
+	state->s[3] ^= state->s[1];
+	state->s[1] ^= state->s[2];
+	state->s[0] ^= state->s[3];
+
+	state->s[2] ^= t;
+
+	state->s[3] = RandomRotate (state->s[3], 11);
+
+	return result;
+}
+
+//
+// unbiased value in [0, range) by multiply-shift. the division is
+// taken only when the low product falls into the biased zone, which
+// for the small ranges used here almost never happens.
+//
+FORCEINLINE ULONG RandomReduce (
+	_Inout_ PRANDOM_STATE state,
+	_In_ ULONG value,
+	_In_ ULONG range
+)
+{
+	ULONG64 m;
+	ULONG threshold;
+
+	m = (ULONG64)value * range;
+
+	if ((ULONG)m < range)
+	{
+		threshold = (0 - range) % range;
+
+		while ((ULONG)m < threshold)
+			m = (ULONG64)RandomNext (state) * range;
+	}
+
+	return (ULONG)(m >> 32);
+}
+
+FORCEINLINE ULONG RandomBounded (
+	_Inout_ PRANDOM_STATE state,
+	_In_ ULONG range
+)
+{
+	return RandomReduce (state, RandomNext (state), range);
+}
+
+FORCEINLINE VOID RandomFill (
+	_Inout_ PRANDOM_STATE state,
+	_Out_writes_ (count) PULONG buffer,
+	_In_ SIZE_T count
+)
+{
+	RANDOM_STATE local;
+
+	// keep the state in registers for the whole batch
+	local = *state;
+
+	for (SIZE_T i = 0; i < count; i++)
+		buffer[i] = RandomNext (&local);
+
+	*state = local;
+}
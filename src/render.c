@@ -0,0 +1,306 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include "render.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define RENDER_SSE2
+#elif defined(_M_ARM64) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RENDER_NEON
+#endif
+
+typedef struct _RENDER_CONTEXT
+{
+	PFRAMEBUFFER framebuffer;
+	PCATLAS_IMAGE atlas;
+} RENDER_CONTEXT, *PRENDER_CONTEXT;
+
+VOID InitializeFramebuffer (
+	_Out_ PFRAMEBUFFER framebuffer,
+	_In_ PULONG pixels,
+	_In_ ULONG width,
+	_In_ ULONG height,
+	_In_ ULONG stride
+)
+{
+	framebuffer->pixels = pixels;
+	framebuffer->width = width;
+	framebuffer->height = height;
+	framebuffer->stride = stride;
+
+	ResetFramebufferDirty (framebuffer);
+}
+
+VOID ResetFramebufferDirty (
+	_Inout_ PFRAMEBUFFER framebuffer
+)
+{
+	framebuffer->left = (LONG)framebuffer->width;
+	framebuffer->top = (LONG)framebuffer->height;
+	framebuffer->right = 0;
+	framebuffer->bottom = 0;
+}
+
+FORCEINLINE VOID CopyRow (
+	_Out_writes_ (count) PULONG dest,
+	_In_reads_ (count) CONST ULONG *src,
+	_In_ ULONG count
+)
+{
+	ULONG i = 0;
+
+#if defined(RENDER_SSE2)
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_si128 ((__m128i *)(dest + i), _mm_loadu_si128 ((CONST __m128i *)(src + i)));
+#elif defined(RENDER_NEON)
+	for (; i + 4 <= count; i += 4)
+		vst1q_u32 (dest + i, vld1q_u32 (src + i));
+#endif
+
+	for (; i < count; i++)
+		dest[i] = src[i];
+}
+
+//
+// scale is a constant in the specialized kernels below, so the cell size
+// is known at compile time and the row copy is unrolled. the generic
+// kernel reads it from the atlas.
+//
+FORCEINLINE VOID RenderGlyphCell (
+	_Inout_ PFRAMEBUFFER framebuffer,
+	_In_ PCATLAS_IMAGE atlas,
+	_In_ ULONG x,
+	_In_ ULONG y,
+	_In_ GLYPH glyph,
+	_In_ ULONG scale
+)
+{
+	CONST ULONG *src;
+	PULONG dest;
+	ULONG xpos;
+	ULONG ypos;
+	ULONG width;
+	ULONG height;
+	ULONG cell_width;
+	ULONG cell_height;
+
+	// cells are as large as the glyphs of the atlas
+	cell_width = GLYPH_WIDTH * scale;
+	cell_height = GLYPH_HEIGHT * scale;
+
+	xpos = x * cell_width;
+	ypos = y * cell_height;
+
+	if (xpos >= framebuffer->width || ypos >= framebuffer->height)
+		return;
+
+	// the last column and row are clipped by the frame edge
+	width = framebuffer->width - xpos;
+	height = framebuffer->height - ypos;
+
+	if (width > cell_width)
+		width = cell_width;
+
+	if (height > cell_height)
+		height = cell_height;
+
+	src = atlas->pixels + ((SIZE_T)GlyphIntensity (glyph) * cell_height * atlas->width) + ((SIZE_T)GlyphIndex (glyph) * cell_width);
+	dest = framebuffer->pixels + ((SIZE_T)ypos * framebuffer->stride) + xpos;
+
+	if (width == cell_width)
+	{
+		for (ULONG row = 0; row < height; row++)
+		{
+			CopyRow (dest, src, cell_width);
+
+			src += atlas->width;
+			dest += framebuffer->stride;
+		}
+	}
+	else
+	{
+		for (ULONG row = 0; row < height; row++)
+		{
+			CopyRow (dest, src, width);
+
+			src += atlas->width;
+			dest += framebuffer->stride;
+		}
+	}
+
+	if ((LONG)xpos < framebuffer->left)
+		framebuffer->left = xpos;
+
+	if ((LONG)ypos < framebuffer->top)
+		framebuffer->top = ypos;
+
+	if ((LONG)(xpos + width) > framebuffer->right)
+		framebuffer->right = xpos + width;
+
+	if ((LONG)(ypos + height) > framebuffer->bottom)
+		framebuffer->bottom = ypos + height;
+}
+
+VOID RenderGlyph (
+	_Inout_ PFRAMEBUFFER framebuffer,
+	_In_ PCATLAS_IMAGE atlas,
+	_In_ ULONG x,
+	_In_ ULONG y,
+	_In_ GLYPH glyph
+)
+{
+	RenderGlyphCell (framebuffer, atlas, x, y, glyph, atlas->scale);
+}
+
+static VOID RenderGlyphCallback (
+	_In_opt_ PVOID context,
+	_In_ ULONG x,
+	_In_ ULONG y,
+	_In_ GLYPH glyph
+)
+{
+	PRENDER_CONTEXT render;
+
+	render = context;
+
+	RenderGlyphCell (render->framebuffer, render->atlas, x, y, glyph, render->atlas->scale);
+}
+
+// a kernel with the scale as a constant, the cell loop is specialized for it
+#define RENDER_GLYPH_CALLBACK(name, scale) \
+	static VOID name ( \
+		_In_opt_ PVOID context, \
+		_In_ ULONG x, \
+		_In_ ULONG y, \
+		_In_ GLYPH glyph \
+	) \
+	{ \
+		PRENDER_CONTEXT render; \
+		\
+		render = context; \
+		\
+		RenderGlyphCell (render->framebuffer, render->atlas, x, y, glyph, scale); \
+	}
+
+RENDER_GLYPH_CALLBACK (RenderGlyphCallback1, 1)
+RENDER_GLYPH_CALLBACK (RenderGlyphCallback2, 2)
+RENDER_GLYPH_CALLBACK (RenderGlyphCallback3, 3)
+
+// indexed by the scale, any scale past the end takes the generic kernel
+static PMATRIX_DRAW_CALLBACK render_glyph_callbacks[] = {
+	&RenderGlyphCallback,
+	&RenderGlyphCallback1,
+	&RenderGlyphCallback2,
+	&RenderGlyphCallback3,
+};
+
+PMATRIX_DRAW_CALLBACK GetRenderKernel (
+	_In_ ULONG scale
+)
+{
+	if (scale < RTL_NUMBER_OF (render_glyph_callbacks))
+		return render_glyph_callbacks[scale];
+
+	return &RenderGlyphCallback;
+}
+
+ULONG RenderMatrix (
+	_Inout_ PMATRIX matrix,
+	_Inout_ PFRAMEBUFFER framebuffer,
+	_In_ PCATLAS_IMAGE atlas,
+	_In_ PMATRIX_DRAW_CALLBACK kernel
+)
+{
+	RENDER_CONTEXT render;
+
+	render.framebuffer = framebuffer;
+	render.atlas = atlas;
+
+	return RedrawMatrix (matrix, kernel, &render);
+}
+
+ULONG64 HashFramebuffer (
+	_In_ PFRAMEBUFFER framebuffer
+)
+{
+	PULONG row;
+	ULONG64 hash;
+
+	hash = PlatformHash64 (PLATFORM_HASH_BASIS, framebuffer->width);
+	hash = PlatformHash64 (hash, framebuffer->height);
+
+	for (ULONG y = 0; y < framebuffer->height; y++)
+	{
+		row = framebuffer->pixels + ((SIZE_T)y * framebuffer->stride);
+
+		for (ULONG x = 0; x < framebuffer->width; x++)
+			hash = PlatformHash64 (hash, row[x]);
+	}
+
+	return hash;
+}
+
+BOOLEAN FindFramebufferDifference (
+	_In_ PFRAMEBUFFER framebuffer,
+	_In_ PFRAMEBUFFER other,
+	_Out_ PULONG x,
+	_Out_ PULONG y
+)
+{
+	PULONG row;
+	PULONG other_row;
+
+	*x = 0;
+	*y = 0;
+
+	if (framebuffer->width != other->width || framebuffer->height != other->height)
+		return TRUE;
+
+	for (ULONG i = 0; i < framebuffer->height; i++)
+	{
+		row = framebuffer->pixels + ((SIZE_T)i * framebuffer->stride);
+		other_row = other->pixels + ((SIZE_T)i * other->stride);
+
+		for (ULONG j = 0; j < framebuffer->width; j++)
+		{
+			if (row[j] != other_row[j])
+			{
+				*x = j;
+				*y = i;
+
+				return TRUE;
+			}
+		}
+	}
+
+	return FALSE;
+}
+
+ULONG GetRenderScale (
+	_In_ ULONG width,
+	_In_ ULONG height,
+	_In_ ULONG dpi,
+	_In_ ULONG cells_target
+)
+{
+	ULONG64 cells;
+	ULONG scale;
+
+	// 150% and up draws 2x glyphs, 250% and up 3x
+	scale = (dpi + (RENDER_DPI_DEFAULT / 2)) / RENDER_DPI_DEFAULT;
+
+	if (!scale)
+		scale = 1;
+
+	for (; scale < ATLAS_SCALE_MAX; scale++)
+	{
+		cells = (ULONG64)GetRenderColumns (width, scale) * GetRenderRows (height, scale);
+
+		if (!cells_target || cells <= cells_target)
+			break;
+	}
+
+	return (scale < ATLAS_SCALE_MAX) ? scale : ATLAS_SCALE_MAX;
+}
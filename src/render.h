@@ -0,0 +1,108 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+#include "atlas.h"
+#include "matrix.h"
+
+#define RENDER_DPI_DEFAULT 96 // dpi of a 100% display
+#define RENDER_CELLS_TARGET 20000 // about a 1080p grid, larger displays get larger glyphs
+
+// 32-bit top-down frame, glyphs are composed here and the front end
+// presents the changed area once per frame
+typedef struct _FRAMEBUFFER
+{
+	PULONG pixels;
+
+	ULONG width;
+	ULONG height;
+	ULONG stride; // pixels per row
+
+	// area changed since the last present, empty when right <= left
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+} FRAMEBUFFER, *PFRAMEBUFFER;
+
+VOID InitializeFramebuffer (
+	_Out_ PFRAMEBUFFER framebuffer,
+	_In_ PULONG pixels,
+	_In_ ULONG width,
+	_In_ ULONG height,
+	_In_ ULONG stride
+);
+
+VOID ResetFramebufferDirty (
+	_Inout_ PFRAMEBUFFER framebuffer
+);
+
+FORCEINLINE BOOLEAN IsFramebufferDirty (
+	_In_ PFRAMEBUFFER framebuffer
+)
+{
+	return framebuffer->right > framebuffer->left && framebuffer->bottom > framebuffer->top;
+}
+
+VOID RenderGlyph (
+	_Inout_ PFRAMEBUFFER framebuffer,
+	_In_ PCATLAS_IMAGE atlas,
+	_In_ ULONG x,
+	_In_ ULONG y,
+	_In_ GLYPH glyph
+);
+
+// cell kernel for atlases of this scale, looked up when the scale changes
+// instead of for every frame
+PMATRIX_DRAW_CALLBACK GetRenderKernel (
+	_In_ ULONG scale
+);
+
+// the kernel has to come from GetRenderKernel for the scale of the atlas
+ULONG RenderMatrix (
+	_Inout_ PMATRIX matrix,
+	_Inout_ PFRAMEBUFFER framebuffer,
+	_In_ PCATLAS_IMAGE atlas,
+	_In_ PMATRIX_DRAW_CALLBACK kernel
+);
+
+// hash of the size and the visible pixels, the stride padding is left out
+ULONG64 HashFramebuffer (
+	_In_ PFRAMEBUFFER framebuffer
+);
+
+// first pixel, row by row, that differs. frames of different sizes differ
+// at 0, 0. returns FALSE when they are the same.
+BOOLEAN FindFramebufferDifference (
+	_In_ PFRAMEBUFFER framebuffer,
+	_In_ PFRAMEBUFFER other,
+	_Out_ PULONG x,
+	_Out_ PULONG y
+);
+
+FORCEINLINE ULONG GetRenderColumns (
+	_In_ ULONG width,
+	_In_ ULONG scale
+)
+{
+	return width / (GLYPH_WIDTH * scale) + 1;
+}
+
+FORCEINLINE ULONG GetRenderRows (
+	_In_ ULONG height,
+	_In_ ULONG scale
+)
+{
+	return height / (GLYPH_HEIGHT * scale) + 1;
+}
+
+// at least the dpi scale, then larger until the grid fits the cell target (0 for none)
+ULONG GetRenderScale (
+	_In_ ULONG width,
+	_In_ ULONG height,
+	_In_ ULONG dpi,
+	_In_ ULONG cells_target
+);
@@ -32,8 +32,8 @@
 #define IDC_RANDOMIZESMOOTH_CHK 119
 #define IDC_ISCLOSEONESC_CHK 120
 
-// Bitmaps
-#define IDR_GLYPH 1
+// Atlas
+#define IDR_ATLAS 1
 
 // Cursors
 #define IDR_CURSOR 2
@@ -0,0 +1,88 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include "scheduler.h"
+
+static ULONG64 SchedulerDefaultClock (
+	_In_opt_ PVOID context
+)
+{
+	(VOID)context;
+
+	return PlatformQueryNanoseconds ();
+}
+
+VOID InitializeScheduler (
+	_Out_ PSCHEDULER scheduler,
+	_In_ ULONG64 step,
+	_In_ ULONG max_steps,
+	_In_opt_ PSCHEDULER_CLOCK clock,
+	_In_opt_ PVOID context
+)
+{
+	RtlZeroMemory (scheduler, sizeof (SCHEDULER));
+
+	scheduler->clock = clock ? clock : &SchedulerDefaultClock;
+	scheduler->context = context;
+
+	scheduler->step = step ? step : 1;
+	scheduler->max_steps = max_steps ? max_steps : 1;
+
+	scheduler->last = scheduler->clock (scheduler->context);
+}
+
+VOID SetSchedulerStep (
+	_Inout_ PSCHEDULER scheduler,
+	_In_ ULONG64 step
+)
+{
+	if (!step)
+		step = 1;
+
+	scheduler->step = step;
+
+	if (scheduler->accumulator >= step)
+		scheduler->accumulator = step - 1;
+}
+
+ULONG AdvanceScheduler (
+	_Inout_ PSCHEDULER scheduler
+)
+{
+	ULONG64 budget;
+	ULONG64 now;
+	ULONG64 count;
+
+	now = scheduler->clock (scheduler->context);
+
+	// clock went backwards, just restart from here
+	if (now > scheduler->last)
+		scheduler->accumulator += now - scheduler->last;
+
+	scheduler->last = now;
+
+	budget = scheduler->step * scheduler->max_steps;
+
+	if (scheduler->accumulator > budget)
+	{
+		scheduler->dropped += (scheduler->accumulator - budget) / scheduler->step;
+		scheduler->accumulator = budget;
+	}
+
+	count = scheduler->accumulator / scheduler->step;
+
+	scheduler->accumulator -= count * scheduler->step;
+	scheduler->steps += count;
+
+	return (ULONG)count;
+}
+
+ULONG64 GetSchedulerDelay (
+	_In_ PSCHEDULER scheduler
+)
+{
+	if (scheduler->accumulator >= scheduler->step)
+		return 0;
+
+	return scheduler->step - scheduler->accumulator;
+}
@@ -0,0 +1,54 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+// returns current time in nanoseconds
+typedef ULONG64 (*PSCHEDULER_CLOCK) (
+	_In_opt_ PVOID context
+);
+
+//
+// fixed timestep scheduler. real elapsed time is accumulated and paid
+// out in whole simulation steps, so the rain keeps its speed whatever
+// the timer granularity is. catch-up is capped, a stall drops the time
+// it could not pay instead of spiralling.
+//
+typedef struct _SCHEDULER
+{
+	PSCHEDULER_CLOCK clock;
+	PVOID context;
+
+	ULONG64 step;
+	ULONG64 accumulator;
+	ULONG64 last;
+
+	ULONG64 steps;
+	ULONG64 dropped;
+
+	ULONG max_steps;
+} SCHEDULER, *PSCHEDULER;
+
+VOID InitializeScheduler (
+	_Out_ PSCHEDULER scheduler,
+	_In_ ULONG64 step,
+	_In_ ULONG max_steps,
+	_In_opt_ PSCHEDULER_CLOCK clock,
+	_In_opt_ PVOID context
+);
+
+VOID SetSchedulerStep (
+	_Inout_ PSCHEDULER scheduler,
+	_In_ ULONG64 step
+);
+
+ULONG AdvanceScheduler (
+	_Inout_ PSCHEDULER scheduler
+);
+
+// time until the next step is due, as of the last advance
+ULONG64 GetSchedulerDelay (
+	_In_ PSCHEDULER scheduler
+);
@@ -0,0 +1,369 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "stats.h"
+
+#define STATS_LINE_LENGTH 512
+
+static PCSTR stats_counter_names[StatsCounterMax] = {
+	"frames",
+	"steps",
+	"cells_stepped",
+	"cells_redrawn",
+	"presents",
+	"atlas_builds",
+	"allocations",
+};
+
+static PCSTR stats_phase_names[StatsPhaseMax] = {
+	"tick_jitter",
+	"simulate",
+	"atlas",
+	"render",
+	"present",
+	"frame",
+};
+
+FORCEINLINE ULONG GetStatsBucket (
+	_In_ ULONG64 value
+)
+{
+	ULONG shift;
+
+	if (value < STATS_SUB_COUNT)
+		return (ULONG)value;
+
+	if (value >> STATS_MAGNITUDES)
+		value = (1ULL << STATS_MAGNITUDES) - 1;
+
+	// top STATS_SUB_BITS bits of the value pick the bucket inside its power of two
+	shift = PlatformFindHighestBit64 (value) - (STATS_SUB_BITS - 1);
+
+	return STATS_SUB_COUNT + (shift - 1) * (STATS_SUB_COUNT / 2) + (ULONG)(value >> shift) - (STATS_SUB_COUNT / 2);
+}
+
+// highest value that falls into the bucket
+FORCEINLINE ULONG64 GetStatsBucketLimit (
+	_In_ ULONG index
+)
+{
+	ULONG shift;
+	ULONG64 sub;
+
+	if (index < STATS_SUB_COUNT)
+		return index;
+
+	shift = (index - STATS_SUB_COUNT) / (STATS_SUB_COUNT / 2) + 1;
+	sub = (index - STATS_SUB_COUNT) % (STATS_SUB_COUNT / 2) + (STATS_SUB_COUNT / 2);
+
+	return ((sub + 1) << shift) - 1;
+}
+
+static VOID WriteStatsLine (
+	_In_ PSTATS_WRITER writer,
+	_In_opt_ PVOID context,
+	_In_ PCSTR format,
+	...
+)
+{
+	CHAR buffer[STATS_LINE_LENGTH];
+	va_list args;
+	int length;
+
+	va_start (args, format);
+	length = vsnprintf (buffer, sizeof (buffer), format, args);
+	va_end (args);
+
+	if (length <= 0)
+		return;
+
+	if (length >= (int)sizeof (buffer))
+		length = (int)sizeof (buffer) - 1;
+
+	writer (context, buffer, (SIZE_T)length);
+}
+
+BOOLEAN InitializeStats (
+	_Out_ PSTATS stats,
+	_In_ ULONG id,
+	_In_ ULONG trace_events
+)
+{
+	RtlZeroMemory (stats, sizeof (STATS));
+
+	stats->id = id;
+
+	if (trace_events)
+	{
+		stats->events = calloc (trace_events, sizeof (STATS_EVENT));
+
+		if (!stats->events)
+			return FALSE;
+
+		stats->event_capacity = trace_events;
+	}
+
+	return TRUE;
+}
+
+VOID DeleteStats (
+	_Inout_ PSTATS stats
+)
+{
+	if (stats->events)
+		free (stats->events);
+
+	stats->events = NULL;
+	stats->event_capacity = 0;
+	stats->event_count = 0;
+}
+
+VOID RecordStatsValue (
+	_Inout_ PSTATS stats,
+	_In_ STATS_PHASE phase,
+	_In_ ULONG64 value
+)
+{
+	PSTATS_HISTOGRAM histogram;
+
+	histogram = &stats->histogram[phase];
+
+	if (!histogram->count || value < histogram->min)
+		histogram->min = value;
+
+	if (value > histogram->max)
+		histogram->max = value;
+
+	histogram->count += 1;
+	histogram->total += value;
+
+	histogram->bucket[GetStatsBucket (value)] += 1;
+}
+
+VOID RecordStatsPhase (
+	_Inout_ PSTATS stats,
+	_In_ STATS_PHASE phase,
+	_In_ ULONG64 start,
+	_In_ ULONG64 end
+)
+{
+	PSTATS_EVENT event;
+	ULONG64 duration;
+
+	duration = (end > start) ? end - start : 0;
+
+	RecordStatsValue (stats, phase, duration);
+
+	if (!stats->event_capacity)
+		return;
+
+	event = &stats->events[stats->event_count % stats->event_capacity];
+
+	event->start = start;
+	event->duration = duration;
+	event->phase = phase;
+	event->id = stats->id;
+
+	stats->event_count += 1;
+}
+
+ULONG64 GetStatsPercentile (
+	_In_ PSTATS_HISTOGRAM histogram,
+	_In_ ULONG permille
+)
+{
+	ULONG64 target;
+	ULONG64 seen = 0;
+	ULONG64 limit;
+
+	if (!histogram->count)
+		return 0;
+
+	if (permille > 1000)
+		permille = 1000;
+
+	// rank of the value, rounded up so the median of two values is the upper one
+	target = (histogram->count * permille + 999) / 1000;
+
+	if (!target)
+		target = 1;
+
+	for (ULONG i = 0; i < STATS_BUCKETS; i++)
+	{
+		seen += histogram->bucket[i];
+
+		if (seen >= target)
+		{
+			limit = GetStatsBucketLimit (i);
+
+			return (limit > histogram->max) ? histogram->max : limit;
+		}
+	}
+
+	return histogram->max;
+}
+
+VOID MergeStats (
+	_Inout_ PSTATS target,
+	_In_ PSTATS source
+)
+{
+	ULONG64 first;
+
+	for (ULONG i = 0; i < StatsCounterMax; i++)
+		target->counter[i] += source->counter[i];
+
+	for (ULONG i = 0; i < StatsPhaseMax; i++)
+	{
+		PSTATS_HISTOGRAM from = &source->histogram[i];
+		PSTATS_HISTOGRAM to = &target->histogram[i];
+
+		if (!from->count)
+			continue;
+
+		if (!to->count || from->min < to->min)
+			to->min = from->min;
+
+		if (from->max > to->max)
+			to->max = from->max;
+
+		to->count += from->count;
+		to->total += from->total;
+
+		for (ULONG j = 0; j < STATS_BUCKETS; j++)
+			to->bucket[j] += from->bucket[j];
+	}
+
+	if (!target->event_capacity || !source->event_count)
+		return;
+
+	// oldest event still in the source ring first
+	first = (source->event_count > source->event_capacity) ? source->event_count - source->event_capacity : 0;
+
+	for (ULONG64 i = first; i < source->event_count; i++)
+	{
+		target->events[target->event_count % target->event_capacity] = source->events[i % source->event_capacity];
+		target->event_count += 1;
+	}
+}
+
+VOID WriteStatsJson (
+	_In_ PSTATS stats,
+	_In_ PSTATS_WRITER writer,
+	_In_opt_ PVOID context
+)
+{
+	PSTATS_HISTOGRAM histogram;
+	BOOLEAN is_first;
+
+	WriteStatsLine (writer, context, "{\n\t\"counters\": {\n");
+
+	for (ULONG i = 0; i < StatsCounterMax; i++)
+	{
+		WriteStatsLine (
+			writer,
+			context,
+			"\t\t\"%s\": %llu%s\n",
+			stats_counter_names[i],
+			(unsigned long long)stats->counter[i],
+			(i + 1 < StatsCounterMax) ? "," : ""
+		);
+	}
+
+	WriteStatsLine (writer, context, "\t},\n\t\"histograms_ns\": {\n");
+
+	for (ULONG i = 0; i < StatsPhaseMax; i++)
+	{
+		histogram = &stats->histogram[i];
+
+		WriteStatsLine (
+			writer,
+			context,
+			"\t\t\"%s\": {\"count\": %llu, \"min\": %llu, \"mean\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu, \"buckets\": [",
+			stats_phase_names[i],
+			(unsigned long long)histogram->count,
+			(unsigned long long)histogram->min,
+			(unsigned long long)(histogram->count ? histogram->total / histogram->count : 0),
+			(unsigned long long)GetStatsPercentile (histogram, 500),
+			(unsigned long long)GetStatsPercentile (histogram, 900),
+			(unsigned long long)GetStatsPercentile (histogram, 990),
+			(unsigned long long)GetStatsPercentile (histogram, 999),
+			(unsigned long long)histogram->max
+		);
+
+		// only the filled buckets, as [highest value, count] pairs
+		is_first = TRUE;
+
+		for (ULONG j = 0; j < STATS_BUCKETS; j++)
+		{
+			if (!histogram->bucket[j])
+				continue;
+
+			WriteStatsLine (
+				writer,
+				context,
+				"%s[%llu, %llu]",
+				is_first ? "" : ", ",
+				(unsigned long long)GetStatsBucketLimit (j),
+				(unsigned long long)histogram->bucket[j]
+			);
+
+			is_first = FALSE;
+		}
+
+		WriteStatsLine (writer, context, "]}%s\n", (i + 1 < StatsPhaseMax) ? "," : "");
+	}
+
+	WriteStatsLine (writer, context, "\t}\n}\n");
+}
+
+VOID WriteStatsTrace (
+	_In_ PSTATS stats,
+	_In_ PSTATS_WRITER writer,
+	_In_opt_ PVOID context
+)
+{
+	PSTATS_EVENT event;
+	ULONG64 origin = 0;
+	ULONG64 first;
+	BOOLEAN is_first = TRUE;
+
+	WriteStatsLine (writer, context, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+	first = (stats->event_count > stats->event_capacity) ? stats->event_count - stats->event_capacity : 0;
+
+	// timestamps start at the oldest event kept
+	for (ULONG64 i = first; i < stats->event_count; i++)
+	{
+		event = &stats->events[i % stats->event_capacity];
+
+		if (i == first || event->start < origin)
+			origin = event->start;
+	}
+
+	for (ULONG64 i = first; i < stats->event_count; i++)
+	{
+		event = &stats->events[i % stats->event_capacity];
+
+		// the span unit is microseconds
+		WriteStatsLine (
+			writer,
+			context,
+			"%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %llu.%03u, \"dur\": %llu.%03u}",
+			is_first ? "" : ",\n",
+			stats_phase_names[event->phase],
+			(unsigned)event->id,
+			(unsigned long long)((event->start - origin) / 1000),
+			(unsigned)((event->start - origin) % 1000),
+			(unsigned long long)(event->duration / 1000),
+			(unsigned)(event->duration % 1000)
+		);
+
+		is_first = FALSE;
+	}
+
+	WriteStatsLine (writer, context, "\n]}\n");
+}
@@ -0,0 +1,139 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+#define STATS_SUB_BITS 5 // 16 buckets per power of two, about 6% precision
+#define STATS_MAGNITUDES 40 // values up to 2^40 ns, about 18 minutes
+#define STATS_SUB_COUNT (1UL << STATS_SUB_BITS)
+#define STATS_BUCKETS (STATS_SUB_COUNT + (STATS_MAGNITUDES - STATS_SUB_BITS) * (STATS_SUB_COUNT / 2))
+
+#define STATS_TRACE_EVENTS 8192 // phases kept for the trace, the oldest are overwritten
+
+typedef enum _STATS_COUNTER
+{
+	StatsFrames,
+	StatsSteps,
+	StatsCellsStepped, // grid cells times steps, not only the cells that changed
+	StatsCellsRedrawn,
+	StatsPresents,
+	StatsAtlasBuilds,
+	StatsAllocations,
+	StatsCounterMax
+} STATS_COUNTER;
+
+typedef enum _STATS_PHASE
+{
+	StatsTickJitter, // how late the display woke up for the last due step
+	StatsSimulate,
+	StatsAtlas,
+	StatsRender,
+	StatsPresent,
+	StatsFrame,
+	StatsPhaseMax
+} STATS_PHASE;
+
+//
+// log-linear histogram of nanoseconds: exact below 32, then 16 buckets
+// per power of two. recording is one bit scan and one increment, and
+// histograms from different threads merge by adding the buckets.
+//
+typedef struct _STATS_HISTOGRAM
+{
+	ULONG64 count;
+	ULONG64 total;
+	ULONG64 min;
+	ULONG64 max;
+
+	ULONG64 bucket[STATS_BUCKETS];
+} STATS_HISTOGRAM, *PSTATS_HISTOGRAM;
+
+typedef struct _STATS_EVENT
+{
+	ULONG64 start;
+	ULONG64 duration;
+
+	ULONG phase;
+	ULONG id;
+} STATS_EVENT, *PSTATS_EVENT;
+
+// owned by one thread, no locking; merge into a shared one when done
+typedef struct _STATS
+{
+	ULONG64 counter[StatsCounterMax];
+
+	STATS_HISTOGRAM histogram[StatsPhaseMax];
+
+	// optional ring of phases for the chrome trace
+	PSTATS_EVENT events;
+
+	ULONG64 event_count;
+	ULONG event_capacity;
+
+	ULONG id;
+} STATS, *PSTATS;
+
+typedef VOID (*PSTATS_WRITER) (
+	_In_opt_ PVOID context,
+	_In_reads_ (length) PCSTR text,
+	_In_ SIZE_T length
+);
+
+BOOLEAN InitializeStats (
+	_Out_ PSTATS stats,
+	_In_ ULONG id,
+	_In_ ULONG trace_events
+);
+
+VOID DeleteStats (
+	_Inout_ PSTATS stats
+);
+
+FORCEINLINE VOID AddStatsCounter (
+	_Inout_ PSTATS stats,
+	_In_ STATS_COUNTER counter,
+	_In_ ULONG64 value
+)
+{
+	stats->counter[counter] += value;
+}
+
+VOID RecordStatsValue (
+	_Inout_ PSTATS stats,
+	_In_ STATS_PHASE phase,
+	_In_ ULONG64 value
+);
+
+// histogram and, when tracing, a span from start to end
+VOID RecordStatsPhase (
+	_Inout_ PSTATS stats,
+	_In_ STATS_PHASE phase,
+	_In_ ULONG64 start,
+	_In_ ULONG64 end
+);
+
+// percentile in tenths of a percent, 500 is the median
+ULONG64 GetStatsPercentile (
+	_In_ PSTATS_HISTOGRAM histogram,
+	_In_ ULONG permille
+);
+
+VOID MergeStats (
+	_Inout_ PSTATS target,
+	_In_ PSTATS source
+);
+
+VOID WriteStatsJson (
+	_In_ PSTATS stats,
+	_In_ PSTATS_WRITER writer,
+	_In_opt_ PVOID context
+);
+
+// chrome://tracing and perfetto format, one track per stats id
+VOID WriteStatsTrace (
+	_In_ PSTATS stats,
+	_In_ PSTATS_WRITER writer,
+	_In_opt_ PVOID context
+);
@@ -0,0 +1,221 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include "worker.h"
+
+static VOID DrainWorkerQueues (
+	_In_ PWORKER_POOL pool,
+	_In_ ULONG index
+)
+{
+	PWORKER_QUEUE queue;
+	ULONG begin;
+	ULONG end;
+	LONG block;
+
+	// own queue first, then steal round robin
+	for (ULONG i = 0; i < pool->count; i++)
+	{
+		queue = &pool->queues[(index + i) % pool->count];
+
+		while (TRUE)
+		{
+			block = PlatformInterlockedExchangeAdd (&queue->next, 1);
+
+			if (block >= queue->end)
+				break;
+
+			begin = (ULONG)block * pool->block;
+			end = begin + pool->block;
+
+			if (end > pool->total)
+				end = pool->total;
+
+			pool->routine (pool->context, begin, end);
+		}
+	}
+}
+
+static VOID WorkerThreadProc (
+	_In_opt_ PVOID context
+)
+{
+	PWORKER_THREAD thread;
+	PWORKER_POOL pool;
+	ULONG64 generation = 0;
+
+	thread = context;
+	pool = thread->pool;
+
+	PlatformAcquireLock (&pool->lock);
+
+	while (TRUE)
+	{
+		while (!pool->is_shutdown && pool->generation == generation)
+			PlatformWaitCondition (&pool->start_condition, &pool->lock);
+
+		if (pool->is_shutdown)
+			break;
+
+		generation = pool->generation;
+
+		PlatformReleaseLock (&pool->lock);
+
+		DrainWorkerQueues (pool, thread->index);
+
+		PlatformAcquireLock (&pool->lock);
+
+		if (--pool->running == 0)
+			PlatformWakeAllCondition (&pool->done_condition);
+	}
+
+	PlatformReleaseLock (&pool->lock);
+}
+
+PWORKER_POOL CreateWorkerPool (
+	_In_ ULONG threads
+)
+{
+	PWORKER_POOL pool;
+	ULONG started = 0;
+
+	if (!threads)
+		threads = PlatformGetProcessorCount ();
+
+	if (threads > WORKER_THREADS_MAX)
+		threads = WORKER_THREADS_MAX;
+
+	pool = calloc (1, sizeof (WORKER_POOL));
+
+	if (!pool)
+		return NULL;
+
+	pool->queues = PlatformAllocateAligned (threads * sizeof (WORKER_QUEUE), WORKER_CACHE_LINE);
+	pool->threads = calloc (threads, sizeof (WORKER_THREAD));
+
+	if (!pool->queues || !pool->threads)
+	{
+		if (pool->queues)
+			PlatformFreeAligned (pool->queues);
+
+		free (pool->threads);
+		free (pool);
+
+		return NULL;
+	}
+
+	RtlZeroMemory (pool->queues, threads * sizeof (WORKER_QUEUE));
+
+	PlatformInitializeLock (&pool->dispatch_lock);
+	PlatformInitializeLock (&pool->lock);
+	PlatformInitializeCondition (&pool->start_condition);
+	PlatformInitializeCondition (&pool->done_condition);
+
+	// index 0 belongs to the caller of RunWorkerPool
+	for (ULONG i = 1; i < threads; i++)
+	{
+		pool->threads[started].pool = pool;
+		pool->threads[started].index = i;
+
+		if (!PlatformCreateThread (&pool->threads[started].thread, &WorkerThreadProc, &pool->threads[started]))
+			break;
+
+		started += 1;
+	}
+
+	// run with what could be started
+	pool->count = started + 1;
+
+	return pool;
+}
+
+VOID DestroyWorkerPool (
+	_Inout_ PWORKER_POOL *pool
+)
+{
+	PWORKER_POOL current;
+
+	current = *pool;
+	*pool = NULL;
+
+	if (!current)
+		return;
+
+	PlatformAcquireLock (&current->lock);
+
+	current->is_shutdown = TRUE;
+
+	PlatformWakeAllCondition (&current->start_condition);
+	PlatformReleaseLock (&current->lock);
+
+	for (ULONG i = 0; i < current->count - 1; i++)
+		PlatformJoinThread (current->threads[i].thread);
+
+	PlatformDeleteCondition (&current->done_condition);
+	PlatformDeleteCondition (&current->start_condition);
+	PlatformDeleteLock (&current->lock);
+	PlatformDeleteLock (&current->dispatch_lock);
+
+	PlatformFreeAligned (current->queues);
+
+	free (current->threads);
+	free (current);
+}
+
+VOID RunWorkerPool (
+	_In_ PWORKER_POOL pool,
+	_In_ ULONG total,
+	_In_ ULONG block,
+	_In_ PWORKER_ROUTINE routine,
+	_In_opt_ PVOID context
+)
+{
+	ULONG blocks;
+
+	if (!total)
+		return;
+
+	if (!block)
+		block = 1;
+
+	blocks = (total + block - 1) / block;
+
+	// nothing to share, do not wake anybody
+	if (pool->count == 1 || blocks == 1)
+	{
+		for (ULONG begin = 0; begin < total; begin += block)
+			routine (context, begin, (total - begin > block) ? begin + block : total);
+
+		return;
+	}
+
+	PlatformAcquireLock (&pool->dispatch_lock);
+	PlatformAcquireLock (&pool->lock);
+
+	pool->routine = routine;
+	pool->context = context;
+	pool->block = block;
+	pool->total = total;
+
+	for (ULONG i = 0; i < pool->count; i++)
+	{
+		pool->queues[i].next = (LONG)(((ULONG64)blocks * i) / pool->count);
+		pool->queues[i].end = (LONG)(((ULONG64)blocks * (i + 1)) / pool->count);
+	}
+
+	pool->running = pool->count - 1;
+	pool->generation += 1;
+
+	PlatformWakeAllCondition (&pool->start_condition);
+	PlatformReleaseLock (&pool->lock);
+
+	DrainWorkerQueues (pool, 0);
+
+	PlatformAcquireLock (&pool->lock);
+
+	while (pool->running)
+		PlatformWaitCondition (&pool->done_condition, &pool->lock);
+
+	PlatformReleaseLock (&pool->lock);
+	PlatformReleaseLock (&pool->dispatch_lock);
+}
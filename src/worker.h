@@ -0,0 +1,80 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+#define WORKER_CACHE_LINE 64
+#define WORKER_THREADS_MAX 64
+
+// processes items [begin, end) of the current job
+typedef VOID (*PWORKER_ROUTINE) (
+	_In_opt_ PVOID context,
+	_In_ ULONG begin,
+	_In_ ULONG end
+);
+
+//
+// every participant owns a contiguous range of blocks and claims them
+// front to back, a participant that ran dry steals from the others the
+// same way. queues are padded so claims do not share a cache line.
+//
+typedef struct _WORKER_QUEUE
+{
+	volatile LONG next;
+	LONG end;
+	UCHAR padding[WORKER_CACHE_LINE - 2 * sizeof (LONG)];
+} WORKER_QUEUE, *PWORKER_QUEUE;
+
+typedef struct _WORKER_THREAD
+{
+	struct _WORKER_POOL *pool;
+	PLATFORM_THREAD thread;
+	ULONG index;
+} WORKER_THREAD, *PWORKER_THREAD;
+
+typedef struct _WORKER_POOL
+{
+	// one job at a time, callers queue up here
+	PLATFORM_LOCK dispatch_lock;
+
+	PLATFORM_LOCK lock;
+	PLATFORM_CONDITION start_condition;
+	PLATFORM_CONDITION done_condition;
+
+	PWORKER_QUEUE queues;
+	PWORKER_THREAD threads;
+
+	PWORKER_ROUTINE routine;
+	PVOID context;
+
+	ULONG64 generation;
+
+	ULONG block;
+	ULONG total;
+
+	// participants, the calling thread included
+	ULONG count;
+	ULONG running;
+
+	BOOLEAN is_shutdown;
+} WORKER_POOL, *PWORKER_POOL;
+
+// zero threads means one per processor, the caller counts as one
+PWORKER_POOL CreateWorkerPool (
+	_In_ ULONG threads
+);
+
+VOID DestroyWorkerPool (
+	_Inout_ PWORKER_POOL *pool
+);
+
+// runs routine over [0, total) in blocks and returns once all are done
+VOID RunWorkerPool (
+	_In_ PWORKER_POOL pool,
+	_In_ ULONG total,
+	_In_ ULONG block,
+	_In_ PWORKER_ROUTINE routine,
+	_In_opt_ PVOID context
+);
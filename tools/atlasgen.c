@@ -0,0 +1,111 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+//
+// Host tool that bakes the 8bit glyph sheet into the atlas blob the
+// screensaver embeds as a resource. It does not need windows sdk:
+//
+//	cc -O2 -std=c11 -Isrc tools/atlasgen.c tools/bitmap.c src/atlas.c src/platform.c -o atlasgen
+//
+// Usage:
+//	atlasgen [input.bmp] [output.atlas]
+//
+// The defaults are src/res/glyph.bmp and src/res/glyph.atlas. Run it
+// again whenever glyph.bmp changes, the output is the same for the same
+// input, so an unchanged blob means an unchanged sheet.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "atlas.h"
+
+#include "bitmap.h"
+
+#define ATLASGEN_INPUT_DEFAULT "src/res/glyph.bmp"
+#define ATLASGEN_OUTPUT_DEFAULT "src/res/glyph.atlas"
+
+int main (
+	_In_ int argc,
+	_In_ char **argv
+)
+{
+	ATLAS_SOURCE source;
+	ATLAS_SOURCE check;
+	const char *input = ATLASGEN_INPUT_DEFAULT;
+	const char *output = ATLASGEN_OUTPUT_DEFAULT;
+	PVOID buffer = NULL;
+	FILE *file;
+	SIZE_T size;
+	int status = EXIT_FAILURE;
+
+	if (argc > 3)
+	{
+		fprintf (stderr, "usage: atlasgen [input.bmp] [output.atlas]\n");
+
+		return EXIT_FAILURE;
+	}
+
+	if (argc > 1)
+		input = argv[1];
+
+	if (argc > 2)
+		output = argv[2];
+
+	if (!LoadBitmapSource (input, &source))
+	{
+		fprintf (stderr, "cannot load %s, it has to be an uncompressed 8bit bitmap\n", input);
+
+		return EXIT_FAILURE;
+	}
+
+	size = AtlasGetBlobSize (&source);
+	buffer = malloc (size);
+
+	if (!buffer || !AtlasSaveBlob (&source, buffer, size))
+	{
+		fprintf (stderr, "out of memory\n");
+
+		goto CleanupExit;
+	}
+
+	// what the screensaver will see has to be what was decoded here
+	if (!AtlasLoadBlob (buffer, size, &check) || memcmp (check.pixels, source.pixels, (SIZE_T)source.width * source.height) != 0)
+	{
+		fprintf (stderr, "blob does not read back\n");
+
+		goto CleanupExit;
+	}
+
+	file = fopen (output, "wb");
+
+	if (!file)
+	{
+		fprintf (stderr, "cannot open %s\n", output);
+
+		goto CleanupExit;
+	}
+
+	if (fwrite (buffer, 1, size, file) == size)
+		status = EXIT_SUCCESS;
+
+	if (fclose (file) != 0)
+		status = EXIT_FAILURE;
+
+	if (status != EXIT_SUCCESS)
+	{
+		fprintf (stderr, "write failed\n");
+
+		goto CleanupExit;
+	}
+
+	fprintf (stderr, "%s: %ux%u, %zu bytes\n", output, (unsigned)source.width, (unsigned)source.height, size);
+
+CleanupExit:
+
+	free (buffer);
+	free (source.pixels);
+
+	return status;
+}
@@ -0,0 +1,171 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bitmap.h"
+
+FORCEINLINE ULONG ReadLittleEndian (
+	_In_ CONST UCHAR *data,
+	_In_ ULONG length
+)
+{
+	ULONG value = 0;
+
+	for (ULONG i = length; i > 0; i--)
+		value = (value << 8) | data[i - 1];
+
+	return value;
+}
+
+BOOLEAN LoadBitmapSource (
+	_In_ const char *path,
+	_Out_ PATLAS_SOURCE source
+)
+{
+	COLORREF colors[ATLAS_PALETTE_SIZE] = {0};
+	UCHAR header[54];
+	PUCHAR row;
+	FILE *file;
+	LONG height;
+	ULONG offset;
+	ULONG count;
+	ULONG stride;
+	BOOLEAN is_loaded = FALSE;
+
+	RtlZeroMemory (source, sizeof (ATLAS_SOURCE));
+
+	file = fopen (path, "rb");
+
+	if (!file)
+		return FALSE;
+
+	if (fread (header, 1, sizeof (header), file) != sizeof (header) || header[0] != 'B' || header[1] != 'M')
+		goto CleanupExit;
+
+	// uncompressed 8bit with a colour table only
+	if (ReadLittleEndian (header + 28, 2) != 8 || ReadLittleEndian (header + 30, 4) != 0)
+		goto CleanupExit;
+
+	offset = ReadLittleEndian (header + 10, 4);
+	height = (LONG)ReadLittleEndian (header + 22, 4);
+	count = ReadLittleEndian (header + 46, 4);
+
+	if (!count || count > ATLAS_PALETTE_SIZE)
+		count = ATLAS_PALETTE_SIZE;
+
+	source->width = ReadLittleEndian (header + 18, 4);
+	source->scale = 1;
+	source->height = (ULONG)(height < 0 ? -height : height);
+
+	if (!source->width || !source->height || source->width > 0x10000 || source->height > 0x10000)
+		goto CleanupExit;
+
+	// colour table follows the info header as b, g, r, reserved
+	if (fseek (file, 14 + (long)ReadLittleEndian (header + 14, 4), SEEK_SET) != 0)
+		goto CleanupExit;
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		UCHAR quad[4];
+
+		if (fread (quad, 1, sizeof (quad), file) != sizeof (quad))
+			goto CleanupExit;
+
+		colors[i] = quad[2] | (quad[1] << 8) | ((ULONG)quad[0] << 16);
+	}
+
+	stride = (source->width + 3) & ~3UL;
+
+	source->pixels = malloc ((SIZE_T)source->width * source->height);
+
+	if (!source->pixels || fseek (file, (long)offset, SEEK_SET) != 0)
+		goto CleanupExit;
+
+	// bottom-up rows are stored top-down
+	for (ULONG y = 0; y < source->height; y++)
+	{
+		row = source->pixels + ((SIZE_T)(height > 0 ? source->height - 1 - y : y) * source->width);
+
+		if (fread (row, 1, source->width, file) != source->width)
+			goto CleanupExit;
+
+		if (stride != source->width && fseek (file, (long)(stride - source->width), SEEK_CUR) != 0)
+			goto CleanupExit;
+	}
+
+	AtlasInitializePalette (&source->palette, colors, ATLAS_PALETTE_SIZE);
+
+	is_loaded = TRUE;
+
+CleanupExit:
+
+	fclose (file);
+
+	if (!is_loaded)
+	{
+		free (source->pixels);
+
+		RtlZeroMemory (source, sizeof (ATLAS_SOURCE));
+	}
+
+	return is_loaded;
+}
+
+BOOLEAN LoadAtlasSourceFile (
+	_In_ const char *path,
+	_Out_ PATLAS_SOURCE source
+)
+{
+	ATLAS_SOURCE blob_source;
+	PUCHAR buffer = NULL;
+	FILE *file;
+	long size;
+	BOOLEAN is_loaded = FALSE;
+
+	RtlZeroMemory (source, sizeof (ATLAS_SOURCE));
+
+	file = fopen (path, "rb");
+
+	if (!file)
+		return FALSE;
+
+	if (fseek (file, 0, SEEK_END) != 0 || (size = ftell (file)) <= 0 || fseek (file, 0, SEEK_SET) != 0)
+		goto CleanupExit;
+
+	buffer = malloc ((SIZE_T)size);
+
+	if (!buffer || fread (buffer, 1, (SIZE_T)size, file) != (SIZE_T)size)
+		goto CleanupExit;
+
+	if (!AtlasLoadBlob (buffer, (SIZE_T)size, &blob_source))
+	{
+		fclose (file);
+		free (buffer);
+
+		return LoadBitmapSource (path, source);
+	}
+
+	// own the pixels like a decoded bitmap would
+	source->pixels = malloc ((SIZE_T)blob_source.width * blob_source.height);
+
+	if (!source->pixels)
+		goto CleanupExit;
+
+	RtlCopyMemory (source->pixels, blob_source.pixels, (SIZE_T)blob_source.width * blob_source.height);
+
+	source->width = blob_source.width;
+	source->scale = blob_source.scale;
+	source->height = blob_source.height;
+	source->palette = blob_source.palette;
+
+	is_loaded = TRUE;
+
+CleanupExit:
+
+	fclose (file);
+	free (buffer);
+
+	return is_loaded;
+}
@@ -0,0 +1,20 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+#include "atlas.h"
+
+// the same 8bit sheet the screensaver keeps in its resources, pixels are malloc'd
+BOOLEAN LoadBitmapSource (
+	_In_ const char *path,
+	_Out_ PATLAS_SOURCE source
+);
+
+// 8bit bitmap or prebaked atlas blob, told apart by the header
+BOOLEAN LoadAtlasSourceFile (
+	_In_ const char *path,
+	_Out_ PATLAS_SOURCE source
+);
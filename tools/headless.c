@@ -0,0 +1,1541 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+//
+// Headless driver for the portable core (simulation, atlas and compositor).
+// It does not need windows sdk, any c11 compiler will do:
+//
+//	cc -O2 -std=c11 -pthread -Isrc tools/headless.c tools/bitmap.c tools/hls.c tools/recorder.c tools/verify.c src/atlas.c src/display.c src/governor.c src/matrix.c src/platform.c src/render.c src/scheduler.c src/worker.c -o matrix-headless
+//
+// Usage:
+//	matrix-headless bench [--frames N] [--warmup N] [--seed N] [--hue fixed|smooth] [--threads N]
+//	matrix-headless scheduler
+//	matrix-headless snapshot
+//	matrix-headless displays [--displays N] [--step-ms N] [--slow-ms N] [--duration-ms N]
+//	matrix-headless record [--width N] [--height N] [--frames N] [--fps N] [--seed N] [--hue N|smooth]
+//		[--format y4m|rgba] [--output FILE|-] [--atlas FILE] [--ring N] [--threads N] [--scale N] [--realtime]
+//	matrix-headless governor [--frames N] [--step-ms N] [--sim-us N] [--render-us N] [--light-render-us N] [--noise N] [--seed N]
+//	matrix-headless verify [--golden FILE] [--atlas FILE] [--hls FILE] [--threads N] [--update]
+//
+// "bench" runs the simulation and render pipeline for every resolution and
+// settings case and prints one json object per case on stdout. --threads 0
+// uses one worker per processor, the default of 1 keeps the serial update.
+// matrix_allocations is how many grid blocks came from the heap for the
+// case (a block left in the pool by the previous case is reused), the
+// *_bytes fields are the sizes of the grid, frame and atlas blocks held.
+// a case fails when it built an atlas image more than once for a hue.
+//
+// "scheduler" feeds the scheduler from a scripted clock (steady ticks,
+// bursts, a stall, a clock going back, a change of speed) and checks that
+// it pays out and drops exactly the expected number of steps.
+//
+// "snapshot" saves a running grid and checks that the intact copy restores
+// and draws, and that damaged copies (cells out of the atlas, impossible
+// column state) are refused by RestoreMatrix.
+//
+// "displays" drives fake display surfaces on their own threads, the first
+// one presents slowly. it checks that the others keep their step rate, that
+// one more display can be stopped and started again while they run, and
+// that shutdown does not wait for more than one frame, exits with 1 if not.
+//
+// "record" streams one frame per simulation step as y4m or raw rgba to a
+// file or stdout, a summary goes to stderr. glyphs are read from the 8bit
+// bitmap or prebaked atlas given by --atlas (src/res/glyph.bmp by default),
+// --scale 2 or 3 draws glyphs that much larger. with --realtime frames
+// are paced to --fps and dropped when the writer falls behind, otherwise
+// the simulation waits for a free slot and nothing is dropped.
+//
+// "governor" feeds the quality governor from a synthetic cost model
+// instead of a clock: drawing costs --render-us for the first half of the
+// frames and --light-render-us for the second, with --noise percent of
+// jitter. it prints every level change and exits with 1 when the level
+// does not settle inside the budget or keeps bouncing.
+//
+// "verify" runs fixed seeds at several grid sizes twice: a reference with
+// the serial update, and a variant with the threaded update and a snapshot
+// round trip half way. every frame the grids and the rendered frames are
+// compared cell by cell and pixel by pixel, and the hashes of the reference
+// against the golden file (tools/golden.txt). the first difference is
+// reported and the exit code is 1. --update writes the golden file again,
+// only do that for a change that is meant to change the output. the atlas
+// colour conversion is checked against the table of tools/hlsgen.c when
+// there is one (tools/hls.txt).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "atlas.h"
+#include "display.h"
+#include "governor.h"
+#include "matrix.h"
+#include "render.h"
+#include "scheduler.h"
+
+#include "bitmap.h"
+#include "recorder.h"
+#include "verify.h"
+
+#define BENCH_FRAMES_DEFAULT 1000
+#define BENCH_WARMUP_DEFAULT 100
+#define BENCH_SEED_DEFAULT 1
+
+#define SCHEDULE_MS(ms) ((LONG64)(ms) * 1000000LL)
+#define SCHEDULE_START SCHEDULE_MS (1000)
+
+#define SCHEDULE_STEP SCHEDULE_MS (10)
+#define SCHEDULE_STEPS_MAX 4
+#define SCHEDULE_PHASES 3
+
+#define SNAPSHOT_WIDTH 152 // the settings preview
+#define SNAPSHOT_HEIGHT 112
+#define SNAPSHOT_FRAMES 300
+#define SNAPSHOT_SEED 1
+#define SNAPSHOT_HUE 85
+
+#define DISPLAYS_DEFAULT 3
+#define DISPLAYS_STEP_MS 10
+#define DISPLAYS_SLOW_MS 100
+#define DISPLAYS_DURATION_MS 1000
+
+#define RECORD_WIDTH_DEFAULT 1920
+#define RECORD_HEIGHT_DEFAULT 1080
+#define RECORD_FRAMES_DEFAULT 600
+#define RECORD_FPS_DEFAULT 20 // default speed of the screensaver, 50ms per step
+#define RECORD_ATLAS_DEFAULT "src/res/glyph.bmp"
+
+#define GOVERNOR_FRAMES_DEFAULT 4000
+#define GOVERNOR_STEP_MS 50
+#define GOVERNOR_BUDGET_PERCENT 75 // same share of a step as the screensaver
+#define GOVERNOR_SIM_US 2000
+#define GOVERNOR_RENDER_US 120000 // thin client at a high resolution
+#define GOVERNOR_LIGHT_RENDER_US 10000
+#define GOVERNOR_NOISE_PERCENT 20
+
+typedef struct _BENCH_RESOLUTION
+{
+	const char *name;
+	ULONG width;
+	ULONG height;
+} BENCH_RESOLUTION, *PBENCH_RESOLUTION;
+
+typedef struct _BENCH_SETTINGS
+{
+	LONG density;
+	LONG amount;
+} BENCH_SETTINGS, *PBENCH_SETTINGS;
+
+typedef struct _BENCH_OPTIONS
+{
+	ULONG frames;
+	ULONG warmup;
+	ULONG64 seed;
+	ULONG threads;
+	BOOLEAN is_smooth;
+} BENCH_OPTIONS, *PBENCH_OPTIONS;
+
+// the clock moves by advance before each of calls advances, a step other
+// than zero is set first
+typedef struct _SCHEDULE_PHASE
+{
+	LONG64 advance;
+	ULONG calls;
+	LONG64 step;
+} SCHEDULE_PHASE, *PSCHEDULE_PHASE;
+
+typedef struct _SCHEDULE_CASE
+{
+	const char *name;
+	SCHEDULE_PHASE phase[SCHEDULE_PHASES];
+	ULONG64 steps;
+	ULONG64 dropped;
+} SCHEDULE_CASE, *PSCHEDULE_CASE;
+
+typedef enum _SNAPSHOT_DAMAGE
+{
+	SnapshotDamageNone,
+	SnapshotDamageIntensity,
+	SnapshotDamageIndex,
+	SnapshotDamageHighBit,
+	SnapshotDamageState,
+	SnapshotDamageRunLength,
+	SnapshotDamageBlip,
+	SnapshotDamageRandom
+} SNAPSHOT_DAMAGE;
+
+// one edit to a good snapshot, RestoreMatrix has to refuse all but none
+typedef struct _SNAPSHOT_CASE
+{
+	const char *name;
+	SNAPSHOT_DAMAGE damage;
+} SNAPSHOT_CASE, *PSNAPSHOT_CASE;
+
+typedef struct _RECORD_OPTIONS
+{
+	const char *output;
+	const char *atlas;
+	ULONG64 seed;
+	ULONG width;
+	ULONG height;
+	ULONG frames;
+	ULONG fps;
+	ULONG format;
+	ULONG slots;
+	ULONG threads;
+	ULONG scale;
+	LONG hue;
+	BOOLEAN is_smooth;
+	BOOLEAN is_realtime;
+} RECORD_OPTIONS, *PRECORD_OPTIONS;
+
+typedef struct _GOVERNOR_OPTIONS
+{
+	ULONG64 seed;
+	ULONG frames;
+	ULONG step_ms;
+	ULONG sim_us;
+	ULONG render_us;
+	ULONG light_render_us;
+	ULONG noise;
+} GOVERNOR_OPTIONS, *PGOVERNOR_OPTIONS;
+
+typedef struct _FAKE_SURFACE
+{
+	DISPLAY display;
+	FRAMEBUFFER framebuffer;
+	PCATLAS_IMAGE atlas;
+	PMATRIX_DRAW_CALLBACK kernel;
+	PMATRIX matrix;
+	PULONG pixels;
+	ULONG64 present_ns;
+	ULONG64 steps;
+} FAKE_SURFACE, *PFAKE_SURFACE;
+
+static CONST BENCH_RESOLUTION bench_resolutions[] = {
+	{"preview", 152, 112},
+	{"1080p", 1920, 1080},
+	{"4k", 3840, 2160},
+	{"8k", 7680, 4320},
+	{"3x1080p", 5760, 1080},
+	{"3x4k", 11520, 2160},
+};
+
+static CONST BENCH_SETTINGS bench_settings[] = {
+	{DENSITY_MIN, AMOUNT_MAX},
+	{DENSITY_DEFAULT, AMOUNT_DEFAULT},
+	{DENSITY_MAX, AMOUNT_MAX},
+	{DENSITY_DEFAULT, AMOUNT_MIN},
+};
+
+// 10ms steps, at most 4 of them per advance
+static CONST SCHEDULE_CASE schedule_cases[] = {
+	{"steady", {{SCHEDULE_MS (10), 100, 0}}, 100, 0},
+	{"fast_timer", {{SCHEDULE_MS (1), 100, 0}}, 10, 0},
+	{"burst", {{SCHEDULE_MS (35), 10, 0}}, 35, 0},
+	{"stall", {{SCHEDULE_MS (10), 10, 0}, {SCHEDULE_MS (1000), 1, 0}, {SCHEDULE_MS (10), 10, 0}}, 24, 96},
+	{"clock_back", {{SCHEDULE_MS (20), 1, 0}, {-SCHEDULE_MS (50), 1, 0}, {SCHEDULE_MS (10), 5, 0}}, 7, 0},
+	{"speed_up", {{SCHEDULE_MS (15), 1, 0}, {SCHEDULE_MS (4), 5, SCHEDULE_MS (4)}}, 6, 0},
+	{"slow_down", {{SCHEDULE_MS (4), 5, SCHEDULE_MS (4)}, {SCHEDULE_MS (10), 3, SCHEDULE_MS (10)}}, 8, 0},
+};
+
+static CONST SNAPSHOT_CASE snapshot_cases[] = {
+	{"intact", SnapshotDamageNone},
+	{"intensity", SnapshotDamageIntensity},
+	{"index", SnapshotDamageIndex},
+	{"high_bit", SnapshotDamageHighBit},
+	{"state", SnapshotDamageState},
+	{"run_length", SnapshotDamageRunLength},
+	{"blip", SnapshotDamageBlip},
+	{"random", SnapshotDamageRandom},
+};
+
+// the compositor cost does not depend on the glyph shapes, so a
+// generated sheet of the same geometry as glyph.bmp is used
+static BOOLEAN InitializeSyntheticSource (
+	_Out_ PATLAS_SOURCE source
+)
+{
+	COLORREF colors[ATLAS_PALETTE_SIZE];
+	SIZE_T length;
+
+	RtlZeroMemory (source, sizeof (ATLAS_SOURCE));
+
+	source->width = AMOUNT_MAX * GLYPH_WIDTH;
+	source->height = (MAX_INTENSITY + 1) * GLYPH_HEIGHT;
+	source->scale = 1;
+
+	length = (SIZE_T)source->width * source->height;
+
+	source->pixels = malloc (length);
+
+	if (!source->pixels)
+		return FALSE;
+
+	for (SIZE_T i = 0; i < length; i++)
+		source->pixels[i] = (UCHAR)((i * 7) ^ (i / source->width));
+
+	for (ULONG i = 0; i < ATLAS_PALETTE_SIZE; i++)
+		colors[i] = (i << 8) | (i / 2);
+
+	AtlasInitializePalette (&source->palette, colors, ATLAS_PALETTE_SIZE);
+
+	return TRUE;
+}
+
+static int CompareCost (
+	_In_ const void *a,
+	_In_ const void *b
+)
+{
+	ULONG64 x = *(const ULONG64 *)a;
+	ULONG64 y = *(const ULONG64 *)b;
+
+	return (x > y) - (x < y);
+}
+
+static BOOLEAN BenchCase (
+	_In_ PBENCH_OPTIONS options,
+	_In_opt_ PWORKER_POOL pool,
+	_In_ PCATLAS_SOURCE source,
+	_In_ CONST BENCH_RESOLUTION *resolution,
+	_In_ CONST BENCH_SETTINGS *settings
+)
+{
+	FRAMEBUFFER framebuffer;
+	ATLAS_CACHE cache;
+	PCATLAS_IMAGE atlas;
+	PMATRIX_DRAW_CALLBACK kernel;
+	PMATRIX matrix;
+	PULONG pixels;
+	PULONG64 cost;
+	ULONG64 start;
+	ULONG64 simulated;
+	ULONG64 end;
+	ULONG64 sim_total = 0;
+	ULONG64 render_total = 0;
+	ULONG64 cells_total = 0;
+	ULONG64 allocations;
+	BOOLEAN is_seen[ATLAS_HUE_PERIOD] = {0};
+	ULONG hues = 0;
+	ULONG64 active_total = 0;
+	ULONG cells;
+	LONG hue;
+	BOOLEAN is_ok = TRUE;
+
+	allocations = GetMatrixAllocationCount ();
+
+	matrix = CreateMatrix (resolution->width / GLYPH_WIDTH + 1, resolution->height / GLYPH_HEIGHT + 1, options->seed);
+	pixels = calloc ((SIZE_T)resolution->width * resolution->height, sizeof (ULONG));
+	cost = calloc (options->frames ? options->frames : 1, sizeof (ULONG64));
+
+	if (!matrix || !pixels || !cost)
+	{
+		fprintf (stderr, "out of memory for %s\n", resolution->name);
+
+		if (matrix)
+			DestroyMatrix (&matrix);
+
+		free (pixels);
+		free (cost);
+
+		return FALSE;
+	}
+
+	matrix->density = settings->density;
+	matrix->amount = settings->amount;
+
+	InitializeFramebuffer (&framebuffer, pixels, resolution->width, resolution->height, resolution->width);
+	AtlasCacheInitialize (&cache, source);
+
+	kernel = GetRenderKernel (source->scale);
+
+	hue = 85;
+
+	for (ULONG frame = 0; frame < options->warmup + options->frames; frame++)
+	{
+		if (options->is_smooth)
+			hue = (hue >= 255) ? 1 : hue + 1;
+
+		start = PlatformQueryNanoseconds ();
+
+		UpdateMatrixParallel (matrix, pool);
+
+		simulated = PlatformQueryNanoseconds ();
+
+		if (!is_seen[hue % ATLAS_HUE_PERIOD])
+		{
+			is_seen[hue % ATLAS_HUE_PERIOD] = TRUE;
+			hues += 1;
+		}
+
+		atlas = AtlasCacheGet (&cache, hue);
+		cells = atlas ? RenderMatrix (matrix, &framebuffer, atlas, kernel) : 0;
+
+		ResetFramebufferDirty (&framebuffer);
+
+		end = PlatformQueryNanoseconds ();
+
+		if (frame < options->warmup)
+			continue;
+
+		sim_total += simulated - start;
+		render_total += end - simulated;
+		cells_total += cells;
+		active_total += GetMatrixActiveColumns (matrix);
+
+		cost[frame - options->warmup] = end - start;
+	}
+
+	qsort (cost, options->frames, sizeof (ULONG64), &CompareCost);
+
+	printf (
+		"{\"case\":\"%s\",\"width\":%u,\"height\":%u,\"cols\":%u,\"rows\":%u,\"density\":%d,\"amount\":%d,"
+		"\"hue\":\"%s\",\"seed\":%llu,\"frames\":%u,\"threads\":%u,"
+		"\"ns_per_frame\":%llu,\"p50_ns\":%llu,\"p99_ns\":%llu,\"sim_ns_per_frame\":%llu,\"render_ns_per_frame\":%llu,"
+		"\"cells_per_frame\":%.1f,\"active_columns_per_frame\":%.1f,\"atlas_rebuilds\":%u,\"distinct_hues\":%u,"
+		"\"matrix_allocations\":%llu,\"matrix_bytes\":%llu,\"framebuffer_bytes\":%llu,\"atlas_bytes\":%llu}\n",
+		resolution->name,
+		(unsigned)resolution->width,
+		(unsigned)resolution->height,
+		(unsigned)matrix->numcols,
+		(unsigned)matrix->numrows,
+		(int)settings->density,
+		(int)settings->amount,
+		options->is_smooth ? "smooth" : "fixed",
+		(unsigned long long)options->seed,
+		(unsigned)options->frames,
+		pool ? (unsigned)pool->count : 1,
+		(unsigned long long)((sim_total + render_total) / options->frames),
+		(unsigned long long)cost[(options->frames - 1) / 2],
+		(unsigned long long)cost[((ULONG64)options->frames * 99 - 1) / 100],
+		(unsigned long long)(sim_total / options->frames),
+		(unsigned long long)(render_total / options->frames),
+		(double)cells_total / options->frames,
+		(double)active_total / options->frames,
+		(unsigned)cache.misses,
+		(unsigned)hues,
+		(unsigned long long)(GetMatrixAllocationCount () - allocations),
+		(unsigned long long)matrix->size,
+		(unsigned long long)resolution->width * resolution->height * sizeof (ULONG),
+		(unsigned long long)cache.count * source->width * source->height * sizeof (ULONG)
+	);
+
+	// every hue is built once and then kept
+	if (cache.misses > hues)
+	{
+		fprintf (stderr, "%s: %u atlas builds for %u hues\n", resolution->name, (unsigned)cache.misses, (unsigned)hues);
+
+		is_ok = FALSE;
+	}
+
+	AtlasCacheDestroy (&cache);
+	DestroyMatrix (&matrix);
+
+	free (pixels);
+	free (cost);
+
+	return is_ok;
+}
+
+static int RunBench (
+	_In_ PBENCH_OPTIONS options
+)
+{
+	ATLAS_SOURCE source;
+	PWORKER_POOL pool = NULL;
+	int status = EXIT_SUCCESS;
+
+	if (!InitializeSyntheticSource (&source))
+		return EXIT_FAILURE;
+
+	// one thread keeps the plain serial update
+	if (options->threads != 1)
+		pool = CreateWorkerPool (options->threads);
+
+	for (SIZE_T i = 0; i < RTL_NUMBER_OF (bench_resolutions); i++)
+	{
+		for (SIZE_T j = 0; j < RTL_NUMBER_OF (bench_settings); j++)
+		{
+			if (!BenchCase (options, pool, &source, &bench_resolutions[i], &bench_settings[j]))
+				status = EXIT_FAILURE;
+
+			fflush (stdout);
+		}
+	}
+
+	FlushMatrixPool ();
+	DestroyWorkerPool (&pool);
+
+	free (source.pixels);
+
+	return status;
+}
+
+static ULONG64 ScheduleClock (
+	_In_opt_ PVOID context
+)
+{
+	return *(PULONG64)context;
+}
+
+static int RunScheduler ()
+{
+	CONST SCHEDULE_CASE *schedule;
+	CONST SCHEDULE_PHASE *phase;
+	SCHEDULER scheduler;
+	ULONG64 now;
+	ULONG steps;
+	const char *status;
+	int result = EXIT_SUCCESS;
+
+	for (ULONG i = 0; i < RTL_NUMBER_OF (schedule_cases); i++)
+	{
+		schedule = &schedule_cases[i];
+		status = "ok";
+
+		now = SCHEDULE_START;
+
+		InitializeScheduler (&scheduler, SCHEDULE_STEP, SCHEDULE_STEPS_MAX, &ScheduleClock, &now);
+
+		for (ULONG j = 0; j < SCHEDULE_PHASES; j++)
+		{
+			phase = &schedule->phase[j];
+
+			if (phase->step)
+				SetSchedulerStep (&scheduler, phase->step);
+
+			for (ULONG k = 0; k < phase->calls; k++)
+			{
+				now += phase->advance;
+
+				steps = AdvanceScheduler (&scheduler);
+
+				// a stall is paid with the catch-up cap, never more
+				if (steps > SCHEDULE_STEPS_MAX)
+					status = "over_cap";
+			}
+		}
+
+		if (strcmp (status, "ok") == 0 && (scheduler.steps != schedule->steps || scheduler.dropped != schedule->dropped))
+			status = "mismatch";
+
+		printf ("{\"case\":\"%s\",\"steps\":%llu,\"dropped\":%llu,\"status\":\"%s\"}\n", schedule->name, (unsigned long long)scheduler.steps, (unsigned long long)scheduler.dropped, status);
+
+		if (strcmp (status, "ok") != 0)
+		{
+			fprintf (stderr, "%s: %llu steps and %llu dropped, expected %llu and %llu\n", schedule->name, (unsigned long long)scheduler.steps, (unsigned long long)scheduler.dropped, (unsigned long long)schedule->steps, (unsigned long long)schedule->dropped);
+
+			result = EXIT_FAILURE;
+		}
+	}
+
+	return result;
+}
+
+static VOID DamageSnapshot (
+	_Inout_ PUCHAR buffer,
+	_In_ SNAPSHOT_DAMAGE damage
+)
+{
+	PMATRIX_SNAPSHOT_HEADER header;
+	PMATRIX_SNAPSHOT_COLUMN record;
+	PGLYPH glyphs;
+
+	header = (PMATRIX_SNAPSHOT_HEADER)buffer;
+	record = (PMATRIX_SNAPSHOT_COLUMN)(header + 1);
+	glyphs = (PGLYPH)(record + header->numcols);
+
+	// a cell in the middle of the grid and the column it is in
+	glyphs += ((SIZE_T)(header->numcols / 2) * header->numrows) + (header->numrows / 2);
+	record += header->numcols / 2;
+
+	switch (damage)
+	{
+		case SnapshotDamageIntensity:
+		{
+			*glyphs = (GLYPH)((100 << 8) | 1);
+			break;
+		}
+
+		case SnapshotDamageIndex:
+		{
+			*glyphs = (GLYPH)(((MAX_INTENSITY - 1) << 8) | 200);
+			break;
+		}
+
+		case SnapshotDamageHighBit:
+		{
+			*glyphs = (GLYPH)(*glyphs | 0x8000);
+			break;
+		}
+
+		case SnapshotDamageState:
+		{
+			record->state = 2;
+			break;
+		}
+
+		case SnapshotDamageRunLength:
+		{
+			record->run_length = 0;
+			break;
+		}
+
+		case SnapshotDamageBlip:
+		{
+			record->blip_pos = 0xFFFFFFF0;
+			record->blip_length = 0xFFFFFFFF;
+
+			break;
+		}
+
+		case SnapshotDamageRandom:
+		{
+			RtlZeroMemory (record->random, sizeof (record->random));
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+}
+
+// a good snapshot has to restore and draw, a damaged one must be refused
+// before its cells reach the atlas
+static int RunSnapshot ()
+{
+	FRAMEBUFFER framebuffer;
+	ATLAS_SOURCE source;
+	ATLAS_CACHE cache;
+	PCATLAS_IMAGE atlas;
+	PMATRIX matrix;
+	PMATRIX restored;
+	PUCHAR buffer = NULL;
+	PUCHAR damaged = NULL;
+	PULONG pixels = NULL;
+	const char *status;
+	SIZE_T size = 0;
+	int result = EXIT_FAILURE;
+
+	if (!InitializeSyntheticSource (&source))
+		return EXIT_FAILURE;
+
+	matrix = CreateMatrix (SNAPSHOT_WIDTH / GLYPH_WIDTH + 1, SNAPSHOT_HEIGHT / GLYPH_HEIGHT + 1, SNAPSHOT_SEED);
+
+	if (matrix)
+	{
+		matrix->density = DENSITY_MIN;
+		matrix->amount = AMOUNT_MAX;
+
+		for (ULONG frame = 0; frame < SNAPSHOT_FRAMES; frame++)
+			UpdateMatrix (matrix);
+
+		size = GetMatrixSnapshotSize (matrix);
+		buffer = malloc (size);
+		damaged = malloc (size);
+	}
+
+	pixels = calloc ((SIZE_T)SNAPSHOT_WIDTH * SNAPSHOT_HEIGHT, sizeof (ULONG));
+
+	if (!matrix || !buffer || !damaged || !pixels || !SaveMatrixSnapshot (matrix, buffer, size))
+	{
+		fprintf (stderr, "out of memory for the snapshot checks\n");
+
+		goto CleanupExit;
+	}
+
+	InitializeFramebuffer (&framebuffer, pixels, SNAPSHOT_WIDTH, SNAPSHOT_HEIGHT, SNAPSHOT_WIDTH);
+	AtlasCacheInitialize (&cache, &source);
+
+	atlas = AtlasCacheGet (&cache, SNAPSHOT_HUE);
+
+	result = EXIT_SUCCESS;
+
+	for (ULONG i = 0; i < RTL_NUMBER_OF (snapshot_cases); i++)
+	{
+		RtlCopyMemory (damaged, buffer, size);
+
+		DamageSnapshot (damaged, snapshot_cases[i].damage);
+
+		restored = RestoreMatrix (damaged, size, matrix->numcols, matrix->numrows);
+
+		if (snapshot_cases[i].damage == SnapshotDamageNone)
+		{
+			status = restored ? "ok" : "refused";
+
+			// every cell is drawn once, an atlas read out of range shows up here
+			if (restored && atlas)
+				RenderMatrix (restored, &framebuffer, atlas, GetRenderKernel (source.scale));
+		}
+		else
+		{
+			status = restored ? "accepted" : "ok";
+		}
+
+		if (restored)
+			DestroyMatrix (&restored);
+
+		printf ("{\"case\":\"%s\",\"status\":\"%s\"}\n", snapshot_cases[i].name, status);
+
+		if (strcmp (status, "ok") != 0)
+		{
+			fprintf (stderr, "%s: the snapshot was %s\n", snapshot_cases[i].name, status);
+
+			result = EXIT_FAILURE;
+		}
+	}
+
+	AtlasCacheDestroy (&cache);
+
+CleanupExit:
+
+	if (matrix)
+		DestroyMatrix (&matrix);
+
+	FlushMatrixPool ();
+
+	free (buffer);
+	free (damaged);
+	free (pixels);
+	free (source.pixels);
+
+	return result;
+}
+
+static VOID FakeSurfaceFrame (
+	_In_opt_ PVOID context,
+	_In_ ULONG steps
+)
+{
+	PFAKE_SURFACE surface;
+
+	surface = context;
+
+	for (ULONG i = 0; i < steps; i++)
+		UpdateMatrix (surface->matrix);
+
+	surface->steps += steps;
+
+	RenderMatrix (surface->matrix, &surface->framebuffer, surface->atlas, surface->kernel);
+	ResetFramebufferDirty (&surface->framebuffer);
+
+	// stands in for a slow panel or a remote display
+	if (surface->present_ns)
+		PlatformSleep (surface->present_ns);
+}
+
+static int RunDisplays (
+	_In_ ULONG count,
+	_In_ ULONG step_ms,
+	_In_ ULONG slow_ms,
+	_In_ ULONG duration_ms
+)
+{
+	DISPLAY_COORDINATOR coordinator;
+	FAKE_SURFACE surface[DISPLAY_MAX] = {0};
+	FAKE_SURFACE transient = {0};
+	ATLAS_SOURCE source;
+	ATLAS_CACHE cache = {0};
+	ULONG64 expected;
+	ULONG64 start;
+	ULONG64 shutdown_ns;
+	int status = EXIT_SUCCESS;
+
+	// one is kept for the display that is stopped and started again
+	if (count > DISPLAY_MAX - 1)
+		count = DISPLAY_MAX - 1;
+
+	if (!InitializeSyntheticSource (&source))
+		return EXIT_FAILURE;
+
+	AtlasCacheReference (&cache, &source);
+	InitializeCoordinator (&coordinator);
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		surface[i].matrix = CreateMatrix (1920 / GLYPH_WIDTH + 1, 1080 / GLYPH_HEIGHT + 1, i + 1);
+		surface[i].pixels = calloc ((SIZE_T)1920 * 1080, sizeof (ULONG));
+		surface[i].atlas = AtlasCacheGet (&cache, 85);
+		surface[i].kernel = GetRenderKernel (source.scale);
+		surface[i].present_ns = (i == 0) ? slow_ms * 1000000ULL : 0;
+
+		if (!surface[i].matrix || !surface[i].pixels || !surface[i].atlas)
+		{
+			fprintf (stderr, "out of memory for display %u\n", (unsigned)i);
+
+			status = EXIT_FAILURE;
+
+			break;
+		}
+
+		InitializeFramebuffer (&surface[i].framebuffer, surface[i].pixels, 1920, 1080, 1920);
+		InitializeScheduler (&surface[i].display.scheduler, step_ms * 1000000ULL, 4, NULL, NULL);
+
+		if (!StartDisplay (&coordinator, &surface[i].display, &FakeSurfaceFrame, &surface[i]))
+		{
+			fprintf (stderr, "cannot start display %u\n", (unsigned)i);
+
+			status = EXIT_FAILURE;
+
+			break;
+		}
+	}
+
+	// a fullscreen run that ends next to the settings preview: closing it must
+	// not stop the others, and the next one has to start again
+	transient.matrix = CreateMatrix (152 / GLYPH_WIDTH + 1, 112 / GLYPH_HEIGHT + 1, count + 1);
+	transient.pixels = calloc ((SIZE_T)152 * 112, sizeof (ULONG));
+	transient.atlas = surface[0].atlas;
+	transient.kernel = GetRenderKernel (source.scale);
+
+	if (status == EXIT_SUCCESS && (!transient.matrix || !transient.pixels))
+	{
+		fprintf (stderr, "out of memory for the transient display\n");
+
+		status = EXIT_FAILURE;
+	}
+
+	if (status == EXIT_SUCCESS)
+	{
+		InitializeFramebuffer (&transient.framebuffer, transient.pixels, 152, 112, 152);
+
+		for (ULONG i = 0; i < 2 && status == EXIT_SUCCESS; i++)
+		{
+			InitializeScheduler (&transient.display.scheduler, step_ms * 1000000ULL, 4, NULL, NULL);
+
+			if (!StartDisplay (&coordinator, &transient.display, &FakeSurfaceFrame, &transient))
+			{
+				fprintf (stderr, "cannot start the transient display, run %u\n", (unsigned)i);
+
+				status = EXIT_FAILURE;
+
+				break;
+			}
+
+			PlatformSleep (duration_ms * 1000000ULL / 4);
+
+			RequestStopDisplay (&transient.display);
+			StopDisplay (&transient.display);
+		}
+
+		printf ("{\"transient_steps\":%llu}\n", (unsigned long long)transient.steps);
+
+		if (!transient.steps)
+			status = EXIT_FAILURE;
+	}
+
+	if (status == EXIT_SUCCESS)
+		PlatformSleep (duration_ms * 1000000ULL / 2);
+
+	// every display stops at once, as on input on a fullscreen window
+	start = PlatformQueryNanoseconds ();
+
+	RequestCoordinatorShutdown (&coordinator);
+	DeleteCoordinator (&coordinator);
+
+	shutdown_ns = PlatformQueryNanoseconds () - start;
+
+	expected = duration_ms / (step_ms ? step_ms : 1);
+
+	for (ULONG i = 0; i < count && status == EXIT_SUCCESS; i++)
+	{
+		printf (
+			"{\"display\":%u,\"present_ms\":%u,\"frames\":%llu,\"steps\":%llu,\"dropped\":%llu,\"expected_steps\":%llu}\n",
+			(unsigned)i,
+			(unsigned)(surface[i].present_ns / 1000000),
+			(unsigned long long)surface[i].display.frames,
+			(unsigned long long)surface[i].steps,
+			(unsigned long long)surface[i].display.scheduler.dropped,
+			(unsigned long long)expected
+		);
+
+		// fast displays must not be held back by the slow one
+		if (!surface[i].present_ns && surface[i].steps * 10 < expected * 9)
+			status = EXIT_FAILURE;
+	}
+
+	printf ("{\"shutdown_ns\":%llu}\n", (unsigned long long)shutdown_ns);
+
+	// one frame in flight is the most shutdown may wait for
+	if (shutdown_ns > (slow_ms + step_ms * 4 + 100) * 1000000ULL)
+		status = EXIT_FAILURE;
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		if (surface[i].matrix)
+			DestroyMatrix (&surface[i].matrix);
+
+		free (surface[i].pixels);
+	}
+
+	if (transient.matrix)
+		DestroyMatrix (&transient.matrix);
+
+	free (transient.pixels);
+
+	AtlasCacheDereference (&cache);
+	FlushMatrixPool ();
+
+	free (source.pixels);
+
+	return status;
+}
+
+// cost of one step spread over the frames it is drawn in, nanoseconds
+static ULONG64 GetModelCost (
+	_In_ PGOVERNOR_OPTIONS options,
+	_In_ ULONG render_us,
+	_In_ ULONG stride
+)
+{
+	return ((ULONG64)options->sim_us + render_us / stride) * 1000;
+}
+
+static ULONG64 AddModelNoise (
+	_Inout_ PRANDOM_STATE random,
+	_In_ ULONG64 cost,
+	_In_ ULONG noise
+)
+{
+	ULONG64 jitter;
+
+	if (!noise)
+		return cost;
+
+	jitter = cost * RandomBounded (random, noise * 2 + 1) / 100;
+
+	return cost - (cost * noise / 100) + jitter;
+}
+
+static int RunGovernor (
+	_In_ PGOVERNOR_OPTIONS options
+)
+{
+	GOVERNOR governor;
+	RANDOM_STATE random;
+	ULONG64 pending_cost = 0;
+	ULONG64 budget;
+	ULONG64 cost;
+	ULONG pending_steps = 0;
+	ULONG render_us;
+	ULONG heavy_level = 0;
+	ULONG heavy_changes = 0;
+	ULONG stride;
+	int status = EXIT_SUCCESS;
+
+	budget = (ULONG64)options->step_ms * 10000 * GOVERNOR_BUDGET_PERCENT;
+
+	InitializeGovernor (&governor, budget, GOVERNOR_LEVEL_MAX);
+	RandomSeed (&random, options->seed, 0);
+
+	for (ULONG frame = 0; frame < options->frames; frame++)
+	{
+		if (frame == options->frames / 2)
+		{
+			heavy_level = governor.level;
+			heavy_changes = (ULONG)governor.changes;
+		}
+
+		render_us = (frame < options->frames / 2) ? options->render_us : options->light_render_us;
+
+		// the same bookkeeping as the display thread, one step per wake up
+		stride = GetGovernorStride (&governor);
+
+		pending_cost += AddModelNoise (&random, (ULONG64)options->sim_us * 1000, options->noise);
+		pending_steps += 1;
+
+		if (pending_steps < stride)
+			continue;
+
+		pending_cost += AddModelNoise (&random, (ULONG64)render_us * 1000, options->noise);
+
+		if (UpdateGovernor (&governor, pending_cost, pending_steps))
+		{
+			printf (
+				"{\"frame\":%u,\"level\":%u,\"average_us\":%llu}\n",
+				(unsigned)frame,
+				(unsigned)governor.level,
+				(unsigned long long)(governor.average / 1000)
+			);
+		}
+
+		pending_cost = 0;
+		pending_steps = 0;
+	}
+
+	printf (
+		"{\"budget_us\":%llu,\"heavy_level\":%u,\"heavy_cost_us\":%llu,\"light_level\":%u,\"light_cost_us\":%llu,\"changes\":%llu}\n",
+		(unsigned long long)(budget / 1000),
+		(unsigned)heavy_level,
+		(unsigned long long)(GetModelCost (options, options->render_us, 1UL << heavy_level) / 1000),
+		(unsigned)governor.level,
+		(unsigned long long)(GetModelCost (options, options->light_render_us, GetGovernorStride (&governor)) / 1000),
+		(unsigned long long)governor.changes
+	);
+
+	// settled inside the budget, or as low as it goes
+	cost = GetModelCost (options, options->render_us, 1UL << heavy_level);
+
+	if (cost > budget && heavy_level < GOVERNOR_LEVEL_MAX)
+		status = EXIT_FAILURE;
+
+	// the light half has headroom for full quality unless drawing alone is too slow
+	if (GetModelCost (options, options->light_render_us, 1) * 100 < budget * GOVERNOR_RESTORE_PERCENT && governor.level)
+		status = EXIT_FAILURE;
+
+	// every change is one step towards the settled level, anything more is bouncing
+	if (heavy_changes != heavy_level || governor.level > heavy_level)
+		status = EXIT_FAILURE;
+
+	if (governor.changes - heavy_changes != heavy_level - governor.level)
+		status = EXIT_FAILURE;
+
+	return status;
+}
+
+static int RunRecord (
+	_In_ PRECORD_OPTIONS options
+)
+{
+	FRAMEBUFFER framebuffer;
+	RECORDER recorder;
+	ATLAS_SOURCE source;
+	ATLAS_CACHE cache;
+	PCATLAS_IMAGE atlas;
+	PMATRIX_DRAW_CALLBACK kernel;
+	PWORKER_POOL pool = NULL;
+	PMATRIX matrix;
+	PULONG pixels;
+	PULONG slot;
+	FILE *file;
+	ULONG64 period;
+	ULONG64 deadline;
+	ULONG64 start;
+	ULONG64 now;
+	ULONG64 produce_total = 0;
+	LONG hue;
+	int status = EXIT_SUCCESS;
+
+	if (!LoadAtlasSourceFile (options->atlas, &source))
+	{
+		fprintf (stderr, "cannot load %s, using generated glyphs\n", options->atlas);
+
+		if (!InitializeSyntheticSource (&source))
+			return EXIT_FAILURE;
+	}
+
+	// larger glyphs, the grid shrinks to match
+	if (options->scale > 1)
+	{
+		ATLAS_SOURCE scaled;
+
+		if (!AtlasScaleSource (&source, options->scale, &scaled))
+		{
+			fprintf (stderr, "out of memory\n");
+
+			free (source.pixels);
+
+			return EXIT_FAILURE;
+		}
+
+		free (source.pixels);
+
+		source = scaled;
+	}
+
+	if (strcmp (options->output, "-") == 0)
+	{
+		file = stdout;
+	}
+	else
+	{
+		file = fopen (options->output, "wb");
+
+		if (!file)
+		{
+			fprintf (stderr, "cannot open %s\n", options->output);
+
+			free (source.pixels);
+
+			return EXIT_FAILURE;
+		}
+	}
+
+	matrix = CreateMatrix (GetRenderColumns (options->width, source.scale), GetRenderRows (options->height, source.scale), options->seed);
+	pixels = calloc ((SIZE_T)options->width * options->height, sizeof (ULONG));
+
+	if (!matrix || !pixels || !OpenRecorder (&recorder, file, options->format, options->width, options->height, options->fps, options->slots))
+	{
+		fprintf (stderr, "out of memory\n");
+
+		if (matrix)
+			DestroyMatrix (&matrix);
+
+		if (file != stdout)
+			fclose (file);
+
+		free (pixels);
+		free (source.pixels);
+
+		return EXIT_FAILURE;
+	}
+
+	if (options->threads != 1)
+		pool = CreateWorkerPool (options->threads);
+
+	InitializeFramebuffer (&framebuffer, pixels, options->width, options->height, options->width);
+	AtlasCacheInitialize (&cache, &source);
+
+	kernel = GetRenderKernel (source.scale);
+
+	hue = options->hue;
+	period = 1000000000ULL / options->fps;
+
+	start = PlatformQueryNanoseconds ();
+	deadline = start;
+
+	for (ULONG frame = 0; frame < options->frames; frame++)
+	{
+		if (options->is_realtime)
+		{
+			deadline += period;
+			now = PlatformQueryNanoseconds ();
+
+			if (now < deadline)
+				PlatformSleep (deadline - now);
+		}
+
+		now = PlatformQueryNanoseconds ();
+
+		if (options->is_smooth)
+			hue = (hue >= 255) ? 1 : hue + 1;
+
+		UpdateMatrixParallel (matrix, pool);
+
+		atlas = AtlasCacheGet (&cache, hue);
+
+		if (atlas)
+			RenderMatrix (matrix, &framebuffer, atlas, kernel);
+
+		ResetFramebufferDirty (&framebuffer);
+
+		// the frame buffer is kept between frames, the writer gets a copy
+		slot = AcquireRecorderFrame (&recorder, !options->is_realtime);
+
+		if (slot)
+		{
+			RtlCopyMemory (slot, pixels, (SIZE_T)options->width * options->height * sizeof (ULONG));
+
+			SubmitRecorderFrame (&recorder);
+		}
+		else if (recorder.is_failed)
+		{
+			break;
+		}
+
+		produce_total += PlatformQueryNanoseconds () - now;
+	}
+
+	if (!CloseRecorder (&recorder))
+	{
+		fprintf (stderr, "write failed\n");
+
+		status = EXIT_FAILURE;
+	}
+
+	now = PlatformQueryNanoseconds ();
+
+	fprintf (
+		stderr,
+		"{\"width\":%u,\"height\":%u,\"format\":\"%s\",\"frames\":%u,\"written\":%llu,\"dropped\":%llu,\"stalls\":%llu,"
+		"\"produce_ns_per_frame\":%llu,\"elapsed_ms\":%llu,\"fps\":%.1f}\n",
+		(unsigned)options->width,
+		(unsigned)options->height,
+		(options->format == RECORDER_FORMAT_Y4M) ? "y4m" : "rgba",
+		(unsigned)options->frames,
+		(unsigned long long)recorder.written,
+		(unsigned long long)recorder.dropped,
+		(unsigned long long)recorder.stalls,
+		(unsigned long long)(produce_total / options->frames),
+		(unsigned long long)((now - start) / 1000000),
+		(double)recorder.written * 1e9 / (double)(now - start ? now - start : 1)
+	);
+
+	if (file != stdout)
+	{
+		if (fclose (file) != 0)
+			status = EXIT_FAILURE;
+	}
+
+	AtlasCacheDestroy (&cache);
+	DestroyMatrix (&matrix);
+	DestroyWorkerPool (&pool);
+	FlushMatrixPool ();
+
+	free (pixels);
+	free (source.pixels);
+
+	return status;
+}
+
+static void PrintUsage ()
+{
+	fprintf (stderr, "usage: matrix-headless bench [--frames N] [--warmup N] [--seed N] [--hue fixed|smooth] [--threads N]\n");
+	fprintf (stderr, "       matrix-headless scheduler\n");
+	fprintf (stderr, "       matrix-headless snapshot\n");
+	fprintf (stderr, "       matrix-headless displays [--displays N] [--step-ms N] [--slow-ms N] [--duration-ms N]\n");
+	fprintf (stderr, "       matrix-headless record [--width N] [--height N] [--frames N] [--fps N] [--seed N] [--hue N|smooth]\n");
+	fprintf (stderr, "                              [--format y4m|rgba] [--output FILE|-] [--atlas FILE] [--ring N] [--threads N] [--scale N] [--realtime]\n");
+	fprintf (stderr, "       matrix-headless governor [--frames N] [--step-ms N] [--sim-us N] [--render-us N] [--light-render-us N] [--noise N] [--seed N]\n");
+	fprintf (stderr, "       matrix-headless verify [--golden FILE] [--atlas FILE] [--hls FILE] [--threads N] [--update]\n");
+}
+
+static int ParseDisplays (
+	_In_ int argc,
+	_In_ char **argv
+)
+{
+	ULONG count = DISPLAYS_DEFAULT;
+	ULONG step_ms = DISPLAYS_STEP_MS;
+	ULONG slow_ms = DISPLAYS_SLOW_MS;
+	ULONG duration_ms = DISPLAYS_DURATION_MS;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (i + 1 < argc && strcmp (argv[i], "--displays") == 0)
+		{
+			count = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--step-ms") == 0)
+		{
+			step_ms = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--slow-ms") == 0)
+		{
+			slow_ms = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--duration-ms") == 0)
+		{
+			duration_ms = strtoul (argv[++i], NULL, 10);
+		}
+		else
+		{
+			PrintUsage ();
+
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!count || !step_ms)
+	{
+		PrintUsage ();
+
+		return EXIT_FAILURE;
+	}
+
+	return RunDisplays (count, step_ms, slow_ms, duration_ms);
+}
+
+static int ParseRecord (
+	_In_ int argc,
+	_In_ char **argv
+)
+{
+	RECORD_OPTIONS options = {0};
+
+	options.output = "-";
+	options.atlas = RECORD_ATLAS_DEFAULT;
+	options.seed = BENCH_SEED_DEFAULT;
+	options.width = RECORD_WIDTH_DEFAULT;
+	options.height = RECORD_HEIGHT_DEFAULT;
+	options.frames = RECORD_FRAMES_DEFAULT;
+	options.fps = RECORD_FPS_DEFAULT;
+	options.format = RECORDER_FORMAT_Y4M;
+	options.slots = RECORDER_SLOTS_DEFAULT;
+	options.threads = 1;
+	options.scale = 1;
+	options.hue = 85;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (i + 1 < argc && strcmp (argv[i], "--width") == 0)
+		{
+			options.width = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--height") == 0)
+		{
+			options.height = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--frames") == 0)
+		{
+			options.frames = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--fps") == 0)
+		{
+			options.fps = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--seed") == 0)
+		{
+			options.seed = strtoull (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--hue") == 0)
+		{
+			i += 1;
+
+			if (strcmp (argv[i], "smooth") == 0)
+			{
+				options.is_smooth = TRUE;
+			}
+			else
+			{
+				options.hue = strtol (argv[i], NULL, 10);
+			}
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--format") == 0)
+		{
+			i += 1;
+
+			if (strcmp (argv[i], "y4m") == 0)
+			{
+				options.format = RECORDER_FORMAT_Y4M;
+			}
+			else if (strcmp (argv[i], "rgba") == 0)
+			{
+				options.format = RECORDER_FORMAT_RGBA;
+			}
+			else
+			{
+				PrintUsage ();
+
+				return EXIT_FAILURE;
+			}
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--output") == 0)
+		{
+			options.output = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--atlas") == 0)
+		{
+			options.atlas = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--ring") == 0)
+		{
+			options.slots = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--threads") == 0)
+		{
+			options.threads = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--scale") == 0)
+		{
+			options.scale = strtoul (argv[++i], NULL, 10);
+		}
+		else if (strcmp (argv[i], "--realtime") == 0)
+		{
+			options.is_realtime = TRUE;
+		}
+		else
+		{
+			PrintUsage ();
+
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!options.width || !options.height || !options.frames || !options.fps || options.hue < 0 || !options.scale || options.scale > ATLAS_SCALE_MAX)
+	{
+		PrintUsage ();
+
+		return EXIT_FAILURE;
+	}
+
+	return RunRecord (&options);
+}
+
+static int ParseGovernor (
+	_In_ int argc,
+	_In_ char **argv
+)
+{
+	GOVERNOR_OPTIONS options = {0};
+
+	options.seed = BENCH_SEED_DEFAULT;
+	options.frames = GOVERNOR_FRAMES_DEFAULT;
+	options.step_ms = GOVERNOR_STEP_MS;
+	options.sim_us = GOVERNOR_SIM_US;
+	options.render_us = GOVERNOR_RENDER_US;
+	options.light_render_us = GOVERNOR_LIGHT_RENDER_US;
+	options.noise = GOVERNOR_NOISE_PERCENT;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (i + 1 < argc && strcmp (argv[i], "--frames") == 0)
+		{
+			options.frames = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--step-ms") == 0)
+		{
+			options.step_ms = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--sim-us") == 0)
+		{
+			options.sim_us = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--render-us") == 0)
+		{
+			options.render_us = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--light-render-us") == 0)
+		{
+			options.light_render_us = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--noise") == 0)
+		{
+			options.noise = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--seed") == 0)
+		{
+			options.seed = strtoull (argv[++i], NULL, 10);
+		}
+		else
+		{
+			PrintUsage ();
+
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!options.frames || !options.step_ms || options.noise > 100)
+	{
+		PrintUsage ();
+
+		return EXIT_FAILURE;
+	}
+
+	return RunGovernor (&options);
+}
+
+static int ParseVerify (
+	_In_ int argc,
+	_In_ char **argv
+)
+{
+	VERIFY_OPTIONS options = {0};
+
+	options.golden = VERIFY_GOLDEN_DEFAULT;
+	options.atlas = VERIFY_ATLAS_DEFAULT;
+	options.hls = VERIFY_HLS_DEFAULT;
+	options.threads = VERIFY_THREADS_DEFAULT;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (i + 1 < argc && strcmp (argv[i], "--golden") == 0)
+		{
+			options.golden = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--atlas") == 0)
+		{
+			options.atlas = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--hls") == 0)
+		{
+			options.hls = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--threads") == 0)
+		{
+			options.threads = strtoul (argv[++i], NULL, 10);
+		}
+		else if (strcmp (argv[i], "--update") == 0)
+		{
+			options.is_update = TRUE;
+		}
+		else
+		{
+			PrintUsage ();
+
+			return EXIT_FAILURE;
+		}
+	}
+
+	return RunVerify (&options);
+}
+
+int main (
+	_In_ int argc,
+	_In_ char **argv
+)
+{
+	BENCH_OPTIONS options = {0};
+
+	options.frames = BENCH_FRAMES_DEFAULT;
+	options.warmup = BENCH_WARMUP_DEFAULT;
+	options.seed = BENCH_SEED_DEFAULT;
+	options.threads = 1;
+
+	if (argc == 2 && strcmp (argv[1], "scheduler") == 0)
+		return RunScheduler ();
+
+	if (argc == 2 && strcmp (argv[1], "snapshot") == 0)
+		return RunSnapshot ();
+
+	if (argc >= 2 && strcmp (argv[1], "displays") == 0)
+		return ParseDisplays (argc, argv);
+
+	if (argc >= 2 && strcmp (argv[1], "record") == 0)
+		return ParseRecord (argc, argv);
+
+	if (argc >= 2 && strcmp (argv[1], "governor") == 0)
+		return ParseGovernor (argc, argv);
+
+	if (argc >= 2 && strcmp (argv[1], "verify") == 0)
+		return ParseVerify (argc, argv);
+
+	if (argc < 2 || strcmp (argv[1], "bench") != 0)
+	{
+		PrintUsage ();
+
+		return EXIT_FAILURE;
+	}
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (i + 1 < argc && strcmp (argv[i], "--frames") == 0)
+		{
+			options.frames = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--warmup") == 0)
+		{
+			options.warmup = strtoul (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--seed") == 0)
+		{
+			options.seed = strtoull (argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--hue") == 0)
+		{
+			options.is_smooth = (strcmp (argv[++i], "smooth") == 0);
+		}
+		else if (i + 1 < argc && strcmp (argv[i], "--threads") == 0)
+		{
+			options.threads = strtoul (argv[++i], NULL, 10);
+		}
+		else
+		{
+			PrintUsage ();
+
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!options.frames)
+	{
+		PrintUsage ();
+
+		return EXIT_FAILURE;
+	}
+
+	return RunBench (&options);
+}
@@ -0,0 +1,271 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hls.h"
+
+#include "atlas.h"
+
+#if defined(_WIN32)
+#include <shlwapi.h>
+#pragma comment (lib, "shlwapi.lib")
+#endif // _WIN32
+
+#define HLS_LINE_LENGTH 128
+
+#define HLS_HASH_BASIS 0xCBF29CE484222325ULL
+#define HLS_HASH_PRIME 0x100000001B3ULL
+
+typedef VOID (*PHLS_RGB_TO_HLS) (
+	_In_ COLORREF clr,
+	_Out_ PUSHORT hue,
+	_Out_ PUSHORT lightness,
+	_Out_ PUSHORT saturation
+);
+
+typedef COLORREF (*PHLS_HLS_TO_RGB) (
+	_In_ USHORT hue,
+	_In_ USHORT lightness,
+	_In_ USHORT saturation
+);
+
+// fnv-1a over the bytes of one value
+FORCEINLINE ULONG64 HlsHash (
+	_In_ ULONG64 hash,
+	_In_ ULONG64 value
+)
+{
+	for (ULONG i = 0; i < sizeof (value); i++)
+	{
+		hash ^= (value >> (i * 8)) & 0xFF;
+		hash *= HLS_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+// hls of the 65536 colours with this red value
+static ULONG64 HashRGBToHLS (
+	_In_ PHLS_RGB_TO_HLS routine,
+	_In_ ULONG red
+)
+{
+	ULONG64 hash = HLS_HASH_BASIS;
+	USHORT hue;
+	USHORT lightness;
+	USHORT saturation;
+
+	for (ULONG green = 0; green < 256; green++)
+	{
+		for (ULONG blue = 0; blue < 256; blue++)
+		{
+			routine ((COLORREF)(red | (green << 8) | (blue << 16)), &hue, &lightness, &saturation);
+
+			hash = HlsHash (hash, hue | ((ULONG64)lightness << 16) | ((ULONG64)saturation << 32));
+		}
+	}
+
+	return hash;
+}
+
+// rgb of every lightness and saturation at this hue
+static ULONG64 HashHLSToRGB (
+	_In_ PHLS_HLS_TO_RGB routine,
+	_In_ ULONG hue
+)
+{
+	ULONG64 hash = HLS_HASH_BASIS;
+
+	for (ULONG lightness = 0; lightness <= ATLAS_HLS_MAX; lightness++)
+	{
+		for (ULONG saturation = 0; saturation <= ATLAS_HLS_MAX; saturation++)
+			hash = HlsHash (hash, routine ((USHORT)hue, (USHORT)lightness, (USHORT)saturation));
+	}
+
+	return hash;
+}
+
+#if defined(_WIN32)
+
+static VOID ShellRGBToHLS (
+	_In_ COLORREF clr,
+	_Out_ PUSHORT hue,
+	_Out_ PUSHORT lightness,
+	_Out_ PUSHORT saturation
+)
+{
+	WORD h, l, s;
+
+	ColorRGBToHLS (clr, &h, &l, &s);
+
+	*hue = h;
+	*lightness = l;
+	*saturation = s;
+}
+
+static COLORREF ShellHLSToRGB (
+	_In_ USHORT hue,
+	_In_ USHORT lightness,
+	_In_ USHORT saturation
+)
+{
+	return ColorHLSToRGB (hue, lightness, saturation);
+}
+
+BOOLEAN WriteHlsTable (
+	_In_ FILE *file
+)
+{
+	fprintf (file, "# hlsgen, the shell colour conversion\n");
+	fprintf (file, "# rgb <red> <hash of the hls of every colour with that red>\n");
+	fprintf (file, "# hue <hue> <hash of the rgb of every lightness and saturation at that hue>\n");
+	fprintf (file, "source %s\n", HLS_REFERENCE);
+
+	for (ULONG red = 0; red < 256; red++)
+		fprintf (file, "rgb %u %016llx\n", (unsigned)red, (unsigned long long)HashRGBToHLS (&ShellRGBToHLS, red));
+
+	for (ULONG hue = 0; hue <= HLS_HUE_LAST; hue++)
+		fprintf (file, "hue %u %016llx\n", (unsigned)hue, (unsigned long long)HashHLSToRGB (&ShellHLSToRGB, hue));
+
+	return !ferror (file);
+}
+
+#endif // _WIN32
+
+HLS_CHECK CheckHlsTable (
+	_In_ const char *path
+)
+{
+	char line[HLS_LINE_LENGTH];
+	char source[32] = {0};
+	unsigned long long expected;
+	ULONG64 hash;
+	unsigned value;
+	ULONG reds = 0;
+	ULONG hues = 0;
+	HLS_CHECK status = HlsCheckOk;
+	FILE *file;
+
+	file = fopen (path, "r");
+
+	if (!file)
+		return HlsCheckMissing;
+
+	while (status == HlsCheckOk && fgets (line, sizeof (line), file))
+	{
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+			continue;
+
+		if (sscanf (line, "source %31s", source) == 1)
+		{
+			// a table written from the atlas functions would only compare them with themselves
+			if (strcmp (source, HLS_REFERENCE) != 0)
+			{
+				fprintf (stderr, "%s: written from \"%s\", only a table from %s is a reference\n", path, source, HLS_REFERENCE);
+
+				status = HlsCheckNotReference;
+			}
+
+			continue;
+		}
+
+		if (!source[0])
+		{
+			fprintf (stderr, "%s: no source line before the first entry\n", path);
+
+			status = HlsCheckBadTable;
+
+			continue;
+		}
+
+		if (sscanf (line, "rgb %u %llx", &value, &expected) == 2 && value == reds)
+		{
+			hash = HashRGBToHLS (&AtlasRGBToHLS, value);
+
+			if (hash != expected)
+			{
+				fprintf (stderr, "%s: the colours with red %u convert to %016llx, the table has %016llx\n", path, value, (unsigned long long)hash, expected);
+
+				status = HlsCheckRGBToHLS;
+			}
+
+			reds += 1;
+
+			continue;
+		}
+
+		// the hue lines come after every red
+		if (sscanf (line, "hue %u %llx", &value, &expected) == 2 && reds == 256 && value == hues)
+		{
+			hash = HashHLSToRGB (&AtlasHLSToRGB, value);
+
+			if (hash != expected)
+			{
+				fprintf (stderr, "%s: hue %u converts to %016llx, the table has %016llx\n", path, value, (unsigned long long)hash, expected);
+
+				status = HlsCheckHLSToRGB;
+			}
+
+			hues += 1;
+
+			continue;
+		}
+
+		fprintf (stderr, "%s: bad line \"%s\"\n", path, line);
+
+		status = HlsCheckBadTable;
+	}
+
+	fclose (file);
+
+	if (status == HlsCheckOk && (reds != 256 || hues != HLS_HUE_LAST + 1))
+	{
+		fprintf (stderr, "%s: %u reds and %u hues, the table is not complete\n", path, (unsigned)reds, (unsigned)hues);
+
+		status = HlsCheckBadTable;
+	}
+
+	return status;
+}
+
+const char *GetHlsCheckName (
+	_In_ HLS_CHECK check
+)
+{
+	switch (check)
+	{
+		case HlsCheckOk:
+		{
+			return "ok";
+		}
+
+		case HlsCheckMissing:
+		{
+			return "missing";
+		}
+
+		case HlsCheckNotReference:
+		{
+			return "not_a_reference";
+		}
+
+		case HlsCheckBadTable:
+		{
+			return "bad_table";
+		}
+
+		case HlsCheckRGBToHLS:
+		{
+			return "rgb_to_hls";
+		}
+
+		case HlsCheckHLSToRGB:
+		{
+			return "hls_to_rgb";
+		}
+	}
+
+	return "unknown";
+}
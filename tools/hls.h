@@ -0,0 +1,46 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include <stdio.h>
+
+#include "platform.h"
+
+#define HLS_TABLE_DEFAULT "tools/hls.txt"
+
+// the only source a table is accepted from
+#define HLS_REFERENCE "shlwapi"
+
+// last hue the screensaver can pick, past the period of 240
+#define HLS_HUE_LAST 255
+
+typedef enum _HLS_CHECK
+{
+	HlsCheckOk,
+	HlsCheckMissing,
+	HlsCheckNotReference,
+	HlsCheckBadTable,
+	HlsCheckRGBToHLS,
+	HlsCheckHLSToRGB
+} HLS_CHECK;
+
+#if defined(_WIN32)
+
+// every rgb colour through ColorRGBToHLS and every hue the screensaver
+// uses through ColorHLSToRGB, one hash per red value and per hue
+BOOLEAN WriteHlsTable (
+	_In_ FILE *file
+);
+
+#endif // _WIN32
+
+// AtlasRGBToHLS/AtlasHLSToRGB against a table written by WriteHlsTable,
+// the first difference goes to stderr
+HLS_CHECK CheckHlsTable (
+	_In_ const char *path
+);
+
+const char *GetHlsCheckName (
+	_In_ HLS_CHECK check
+);
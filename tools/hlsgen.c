@@ -0,0 +1,100 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+//
+// Host tool for the reference table of the shell colour conversion that
+// src/atlas.c reproduces. Writing the table needs windows, the table is
+// made from ColorRGBToHLS/ColorHLSToRGB of shlwapi:
+//
+//	cl /O2 /Isrc tools\hlsgen.c tools\hls.c src\atlas.c
+//
+// Checking the atlas conversion against it builds anywhere:
+//
+//	cc -O2 -std=c11 -Isrc tools/hlsgen.c tools/hls.c src/atlas.c -o hlsgen
+//
+// Usage:
+//	hlsgen [output.txt]
+//	hlsgen --check [table.txt]
+//
+// The default for both is tools/hls.txt. The table covers every rgb
+// colour and every hue up to 255, the check exits with 1 on the first
+// difference and on a table that was not written from shlwapi.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "hls.h"
+
+int main (
+	_In_ int argc,
+	_In_ char **argv
+)
+{
+	const char *path = HLS_TABLE_DEFAULT;
+	HLS_CHECK check;
+
+	if (argc > 1 && strcmp (argv[1], "--check") == 0)
+	{
+		if (argc > 3)
+		{
+			fprintf (stderr, "usage: hlsgen --check [table.txt]\n");
+
+			return EXIT_FAILURE;
+		}
+
+		if (argc > 2)
+			path = argv[2];
+
+		check = CheckHlsTable (path);
+
+		if (check == HlsCheckMissing)
+			fprintf (stderr, "cannot open %s, write it on windows with \"hlsgen\"\n", path);
+
+		printf ("{\"case\":\"hls\",\"status\":\"%s\"}\n", GetHlsCheckName (check));
+
+		return (check == HlsCheckOk) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (argc > 2)
+	{
+		fprintf (stderr, "usage: hlsgen [output.txt]\n");
+
+		return EXIT_FAILURE;
+	}
+
+	if (argc > 1)
+		path = argv[1];
+
+#if defined(_WIN32)
+	{
+		FILE *file;
+		BOOLEAN is_written;
+
+		file = fopen (path, "w");
+
+		if (!file)
+		{
+			fprintf (stderr, "cannot open %s\n", path);
+
+			return EXIT_FAILURE;
+		}
+
+		is_written = WriteHlsTable (file);
+
+		if (fclose (file) != 0 || !is_written)
+		{
+			fprintf (stderr, "write failed\n");
+
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+#else
+	fprintf (stderr, "the table is written from shlwapi, run hlsgen on windows\n");
+
+	return EXIT_FAILURE;
+#endif // _WIN32
+}
@@ -0,0 +1,395 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif // _WIN32
+
+#include "recorder.h"
+
+//
+// pixels are colorref values as the screensaver writes them into its
+// dib, so the low byte is shown as blue and the third one as red.
+//
+FORCEINLINE VOID PixelToRGB (
+	_In_ ULONG pixel,
+	_Out_ PULONG r,
+	_Out_ PULONG g,
+	_Out_ PULONG b
+)
+{
+	*r = (pixel >> 16) & 0xFF;
+	*g = (pixel >> 8) & 0xFF;
+	*b = pixel & 0xFF;
+}
+
+static VOID ConvertToRGBA (
+	_In_ PRECORDER recorder,
+	_In_ CONST ULONG *src
+)
+{
+	PUCHAR dest;
+	SIZE_T count;
+	ULONG r;
+	ULONG g;
+	ULONG b;
+
+	dest = recorder->output;
+	count = (SIZE_T)recorder->width * recorder->height;
+
+	for (SIZE_T i = 0; i < count; i++)
+	{
+		PixelToRGB (src[i], &r, &g, &b);
+
+		dest[0] = (UCHAR)r;
+		dest[1] = (UCHAR)g;
+		dest[2] = (UCHAR)b;
+		dest[3] = 0xFF;
+
+		dest += 4;
+	}
+}
+
+FORCEINLINE UCHAR PixelToLuma (
+	_In_ ULONG r,
+	_In_ ULONG g,
+	_In_ ULONG b
+)
+{
+	return (UCHAR)((77 * r + 150 * g + 29 * b + 128) >> 8);
+}
+
+static VOID ConvertToYUV420 (
+	_In_ PRECORDER recorder,
+	_In_ CONST ULONG *src
+)
+{
+	CONST ULONG *row[2];
+	PUCHAR luma[2];
+	PUCHAR plane_y;
+	PUCHAR plane_u;
+	PUCHAR plane_v;
+	ULONG width;
+	ULONG height;
+	ULONG chroma_width;
+	ULONG chroma_height;
+	ULONG r;
+	ULONG g;
+	ULONG b;
+	ULONG sum_r;
+	ULONG sum_g;
+	ULONG sum_b;
+	ULONG u;
+	ULONG v;
+	ULONG x1;
+
+	width = recorder->width;
+	height = recorder->height;
+
+	chroma_width = (width + 1) / 2;
+	chroma_height = (height + 1) / 2;
+
+	plane_y = recorder->output;
+	plane_u = plane_y + ((SIZE_T)width * height);
+	plane_v = plane_u + ((SIZE_T)chroma_width * chroma_height);
+
+	//
+	// one sweep per pair of rows writes both luma rows and the chroma row
+	// between them. full range bt.601 in 8.8 fixed point, chroma from the
+	// average of each 2x2 block, the last row and column are repeated.
+	//
+	for (ULONG y = 0; y < chroma_height; y++)
+	{
+		row[0] = src + ((SIZE_T)y * 2 * width);
+		row[1] = (y * 2 + 1 < height) ? row[0] + width : row[0];
+
+		luma[0] = plane_y + ((SIZE_T)y * 2 * width);
+		luma[1] = (y * 2 + 1 < height) ? luma[0] + width : NULL;
+
+		for (ULONG x = 0; x < chroma_width; x++)
+		{
+			x1 = (x * 2 + 1 < width) ? x * 2 + 1 : x * 2;
+
+			sum_r = sum_g = sum_b = 0;
+
+			for (ULONG i = 0; i < 2; i++)
+			{
+				PixelToRGB (row[i][x * 2], &r, &g, &b);
+
+				sum_r += r;
+				sum_g += g;
+				sum_b += b;
+
+				if (luma[i])
+					luma[i][x * 2] = PixelToLuma (r, g, b);
+
+				PixelToRGB (row[i][x1], &r, &g, &b);
+
+				sum_r += r;
+				sum_g += g;
+				sum_b += b;
+
+				if (luma[i] && x1 != x * 2)
+					luma[i][x1] = PixelToLuma (r, g, b);
+			}
+
+			u = (128 * sum_b + (512 << 8) + 512 - 43 * sum_r - 85 * sum_g) >> 10;
+			v = (128 * sum_r + (512 << 8) + 512 - 107 * sum_g - 21 * sum_b) >> 10;
+
+			// pure blue and red round up past the top
+			*plane_u++ = (UCHAR)((u > 255) ? 255 : u);
+			*plane_v++ = (UCHAR)((v > 255) ? 255 : v);
+		}
+	}
+}
+
+static BOOLEAN WriteRecorderFrame (
+	_Inout_ PRECORDER recorder,
+	_In_ CONST ULONG *src
+)
+{
+	if (recorder->format == RECORDER_FORMAT_Y4M)
+	{
+		if (fputs ("FRAME\n", recorder->file) == EOF)
+			return FALSE;
+
+		ConvertToYUV420 (recorder, src);
+	}
+	else
+	{
+		ConvertToRGBA (recorder, src);
+	}
+
+	return fwrite (recorder->output, 1, recorder->output_size, recorder->file) == recorder->output_size;
+}
+
+static VOID RecorderThreadProc (
+	_In_opt_ PVOID context
+)
+{
+	PRECORDER recorder;
+	PULONG slot;
+	BOOLEAN is_written;
+
+	recorder = context;
+
+	PlatformAcquireLock (&recorder->lock);
+
+	while (TRUE)
+	{
+		while (!recorder->filled && !recorder->is_closing)
+			PlatformWaitCondition (&recorder->condition, &recorder->lock);
+
+		if (!recorder->filled)
+			break;
+
+		slot = recorder->slots[recorder->tail];
+
+		PlatformReleaseLock (&recorder->lock);
+
+		// after a failure the queue is still drained so nobody waits forever
+		is_written = !recorder->is_failed && WriteRecorderFrame (recorder, slot);
+
+		PlatformAcquireLock (&recorder->lock);
+
+		if (is_written)
+		{
+			recorder->written += 1;
+		}
+		else
+		{
+			recorder->is_failed = TRUE;
+		}
+
+		recorder->tail = (recorder->tail + 1) % recorder->count;
+		recorder->filled -= 1;
+
+		PlatformWakeAllCondition (&recorder->condition);
+	}
+
+	PlatformReleaseLock (&recorder->lock);
+
+	fflush (recorder->file);
+}
+
+static VOID FreeRecorderBuffers (
+	_Inout_ PRECORDER recorder
+)
+{
+	if (recorder->slots)
+	{
+		for (ULONG i = 0; i < recorder->count; i++)
+		{
+			if (recorder->slots[i])
+				PlatformFreeAligned (recorder->slots[i]);
+		}
+
+		free (recorder->slots);
+	}
+
+	if (recorder->output)
+		PlatformFreeAligned (recorder->output);
+
+	recorder->slots = NULL;
+	recorder->output = NULL;
+}
+
+BOOLEAN OpenRecorder (
+	_Out_ PRECORDER recorder,
+	_In_ FILE *file,
+	_In_ ULONG format,
+	_In_ ULONG width,
+	_In_ ULONG height,
+	_In_ ULONG fps,
+	_In_ ULONG count
+)
+{
+	SIZE_T frame_size;
+
+	RtlZeroMemory (recorder, sizeof (RECORDER));
+
+	if (!width || !height)
+		return FALSE;
+
+	recorder->file = file;
+	recorder->format = format;
+	recorder->width = width;
+	recorder->height = height;
+	recorder->count = count ? count : RECORDER_SLOTS_DEFAULT;
+
+	frame_size = (SIZE_T)width * height;
+
+	if (format == RECORDER_FORMAT_Y4M)
+	{
+		recorder->output_size = frame_size + (SIZE_T)((width + 1) / 2) * ((height + 1) / 2) * 2;
+	}
+	else
+	{
+		recorder->output_size = frame_size * 4;
+	}
+
+	recorder->slots = calloc (recorder->count, sizeof (PULONG));
+	recorder->output = PlatformAllocateAligned (recorder->output_size, 64);
+
+	if (!recorder->slots || !recorder->output)
+	{
+		FreeRecorderBuffers (recorder);
+
+		return FALSE;
+	}
+
+	for (ULONG i = 0; i < recorder->count; i++)
+	{
+		recorder->slots[i] = PlatformAllocateAligned (frame_size * sizeof (ULONG), 64);
+
+		if (!recorder->slots[i])
+		{
+			FreeRecorderBuffers (recorder);
+
+			return FALSE;
+		}
+	}
+
+#if defined(_WIN32)
+	// video goes to stdout unchanged
+	_setmode (_fileno (file), _O_BINARY);
+#endif // _WIN32
+
+	if (format == RECORDER_FORMAT_Y4M)
+	{
+		if (fprintf (file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg XYSCSS=420JPEG\n", (unsigned)width, (unsigned)height, (unsigned)(fps ? fps : 1)) < 0)
+		{
+			FreeRecorderBuffers (recorder);
+
+			return FALSE;
+		}
+	}
+
+	PlatformInitializeLock (&recorder->lock);
+	PlatformInitializeCondition (&recorder->condition);
+
+	if (!PlatformCreateThread (&recorder->thread, &RecorderThreadProc, recorder))
+	{
+		PlatformDeleteCondition (&recorder->condition);
+		PlatformDeleteLock (&recorder->lock);
+
+		FreeRecorderBuffers (recorder);
+
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+PULONG AcquireRecorderFrame (
+	_Inout_ PRECORDER recorder,
+	_In_ BOOLEAN is_wait
+)
+{
+	PULONG slot = NULL;
+
+	PlatformAcquireLock (&recorder->lock);
+
+	if (recorder->filled == recorder->count && !recorder->is_failed)
+	{
+		if (is_wait)
+		{
+			recorder->stalls += 1;
+
+			while (recorder->filled == recorder->count && !recorder->is_failed)
+				PlatformWaitCondition (&recorder->condition, &recorder->lock);
+		}
+		else
+		{
+			recorder->dropped += 1;
+		}
+	}
+
+	if (recorder->filled < recorder->count && !recorder->is_failed)
+		slot = recorder->slots[recorder->head];
+
+	PlatformReleaseLock (&recorder->lock);
+
+	return slot;
+}
+
+VOID SubmitRecorderFrame (
+	_Inout_ PRECORDER recorder
+)
+{
+	PlatformAcquireLock (&recorder->lock);
+
+	recorder->head = (recorder->head + 1) % recorder->count;
+	recorder->filled += 1;
+
+	PlatformWakeAllCondition (&recorder->condition);
+	PlatformReleaseLock (&recorder->lock);
+}
+
+BOOLEAN CloseRecorder (
+	_Inout_ PRECORDER recorder
+)
+{
+	BOOLEAN is_failed;
+
+	PlatformAcquireLock (&recorder->lock);
+
+	recorder->is_closing = TRUE;
+
+	PlatformWakeAllCondition (&recorder->condition);
+	PlatformReleaseLock (&recorder->lock);
+
+	PlatformJoinThread (recorder->thread);
+
+	is_failed = recorder->is_failed || ferror (recorder->file);
+
+	PlatformDeleteCondition (&recorder->condition);
+	PlatformDeleteLock (&recorder->lock);
+
+	FreeRecorderBuffers (recorder);
+
+	return !is_failed;
+}
@@ -0,0 +1,78 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include <stdio.h>
+
+#include "platform.h"
+
+#define RECORDER_FORMAT_RGBA 0 // raw r, g, b, a bytes per pixel
+#define RECORDER_FORMAT_Y4M 1 // yuv4mpeg2, full range bt.601, 4:2:0
+
+#define RECORDER_SLOTS_DEFAULT 4
+
+//
+// frames are copied into a ring of preallocated slots and converted and
+// written by a writer thread, so the simulation only pays for one copy
+// per frame. when the ring is full the producer either waits or drops
+// the frame, it never waits on the disk in the middle of a step.
+//
+typedef struct _RECORDER
+{
+	FILE *file;
+
+	PLATFORM_LOCK lock;
+	PLATFORM_CONDITION condition;
+	PLATFORM_THREAD thread;
+
+	// raw frame buffer pixels, count slots of width * height
+	PULONG *slots;
+
+	// converted frame, only touched by the writer thread
+	PUCHAR output;
+	SIZE_T output_size;
+
+	ULONG width;
+	ULONG height;
+	ULONG format;
+
+	ULONG count;
+	ULONG head;
+	ULONG tail;
+	ULONG filled;
+
+	ULONG64 written;
+	ULONG64 dropped;
+	ULONG64 stalls;
+
+	BOOLEAN is_closing;
+	BOOLEAN is_failed;
+} RECORDER, *PRECORDER;
+
+BOOLEAN OpenRecorder (
+	_Out_ PRECORDER recorder,
+	_In_ FILE *file,
+	_In_ ULONG format,
+	_In_ ULONG width,
+	_In_ ULONG height,
+	_In_ ULONG fps,
+	_In_ ULONG count
+);
+
+// free slot to copy the next frame into, NULL when the ring is full and
+// is_wait is not set or when writing has failed
+PULONG AcquireRecorderFrame (
+	_Inout_ PRECORDER recorder,
+	_In_ BOOLEAN is_wait
+);
+
+// queues the slot returned by the last acquire
+VOID SubmitRecorderFrame (
+	_Inout_ PRECORDER recorder
+);
+
+// writes the queued frames and returns FALSE if any write failed
+BOOLEAN CloseRecorder (
+	_Inout_ PRECORDER recorder
+);
@@ -0,0 +1,477 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atlas.h"
+#include "matrix.h"
+#include "render.h"
+
+#include "bitmap.h"
+#include "verify.h"
+
+#define VERIFY_HUE 85
+#define VERIFY_LINE_LENGTH 128
+
+typedef struct _VERIFY_CASE
+{
+	const char *name;
+	ULONG width;
+	ULONG height;
+	ULONG scale;
+	ULONG frames;
+	ULONG64 seed;
+	LONG density;
+	LONG amount;
+	BOOLEAN is_smooth;
+} VERIFY_CASE, *PVERIFY_CASE;
+
+// golden hashes of one frame of the reference
+typedef struct _VERIFY_HASH
+{
+	ULONG64 grid;
+	ULONG64 image;
+	BOOLEAN is_present;
+} VERIFY_HASH, *PVERIFY_HASH;
+
+
+// the wide case has enough columns for the threaded update to split them
+static CONST VERIFY_CASE verify_cases[] = {
+	{"preview", 152, 112, 1, 300, 1, DENSITY_MIN, AMOUNT_MAX, FALSE},
+	{"small", 640, 360, 1, 300, 2, DENSITY_DEFAULT, AMOUNT_DEFAULT, TRUE},
+	{"wide", 3840, 240, 1, 200, 3, DENSITY_MAX, AMOUNT_MIN, FALSE},
+	{"tall", 360, 2160, 1, 200, 4, DENSITY_DEFAULT, AMOUNT_MAX, FALSE},
+	{"scaled", 1280, 720, 2, 200, 5, DENSITY_DEFAULT, AMOUNT_DEFAULT, TRUE},
+};
+
+
+static ULONG GetVerifyHashIndex (
+	_In_ ULONG index,
+	_In_ ULONG frame
+)
+{
+	ULONG offset = 0;
+
+	for (ULONG i = 0; i < index; i++)
+		offset += verify_cases[i].frames;
+
+	return offset + frame;
+}
+
+static PVERIFY_HASH LoadVerifyGolden (
+	_In_ const char *path
+)
+{
+	CHAR line[VERIFY_LINE_LENGTH];
+	CHAR name[32];
+	PVERIFY_HASH hashes;
+	unsigned long long grid;
+	unsigned long long image;
+	unsigned frame;
+	ULONG total = 0;
+	ULONG index;
+	FILE *file;
+
+	for (ULONG i = 0; i < RTL_NUMBER_OF (verify_cases); i++)
+		total += verify_cases[i].frames;
+
+	hashes = calloc (total, sizeof (VERIFY_HASH));
+
+	if (!hashes)
+		return NULL;
+
+	file = fopen (path, "r");
+
+	if (!file)
+	{
+		fprintf (stderr, "cannot open %s, write it with --update\n", path);
+
+		free (hashes);
+
+		return NULL;
+	}
+
+	// "<case> <frame> <grid hash> <frame hash>", lines with # are comments
+	while (fgets (line, sizeof (line), file))
+	{
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+			continue;
+
+		if (sscanf (line, "%31s %u %llx %llx", name, &frame, &grid, &image) != 4)
+		{
+			fprintf (stderr, "%s: bad line \"%s\"\n", path, line);
+
+			fclose (file);
+			free (hashes);
+
+			return NULL;
+		}
+
+		for (index = 0; index < RTL_NUMBER_OF (verify_cases); index++)
+		{
+			if (strcmp (verify_cases[index].name, name) == 0)
+				break;
+		}
+
+		// cases that are gone or got shorter are not an error
+		if (index == RTL_NUMBER_OF (verify_cases) || frame >= verify_cases[index].frames)
+			continue;
+
+		hashes[GetVerifyHashIndex (index, frame)].grid = grid;
+		hashes[GetVerifyHashIndex (index, frame)].image = image;
+		hashes[GetVerifyHashIndex (index, frame)].is_present = TRUE;
+	}
+
+	fclose (file);
+
+	return hashes;
+}
+
+// the variant goes through a snapshot, as after a preview restart
+static BOOLEAN RestoreVerifyMatrix (
+	_Inout_ PMATRIX *matrix
+)
+{
+	PMATRIX restored;
+	PVOID buffer;
+	SIZE_T size;
+
+	size = GetMatrixSnapshotSize (*matrix);
+	buffer = malloc (size);
+
+	if (!buffer || !SaveMatrixSnapshot (*matrix, buffer, size))
+	{
+		free (buffer);
+
+		return FALSE;
+	}
+
+	restored = RestoreMatrix (buffer, size, (*matrix)->numcols, (*matrix)->numrows);
+
+	free (buffer);
+
+	if (!restored)
+		return FALSE;
+
+	DestroyMatrix (matrix);
+
+	*matrix = restored;
+
+	return TRUE;
+}
+
+static int RunVerifyCase (
+	_In_opt_ PWORKER_POOL pool,
+	_In_ PCATLAS_SOURCE base,
+	_In_ ULONG index,
+	_In_opt_ PVERIFY_HASH hashes,
+	_In_opt_ FILE *golden
+)
+{
+	CONST VERIFY_CASE *test;
+	FRAMEBUFFER framebuffer;
+	FRAMEBUFFER variant_framebuffer;
+	ATLAS_SOURCE scaled = {0};
+	ATLAS_CACHE cache;
+	PCATLAS_SOURCE source;
+	PCATLAS_IMAGE atlas;
+	PMATRIX_DRAW_CALLBACK kernel;
+	PVERIFY_HASH hash;
+	PMATRIX matrix = NULL;
+	PMATRIX variant = NULL;
+	PULONG pixels = NULL;
+	PULONG variant_pixels = NULL;
+	const char *status = "ok";
+	ULONG64 grid = 0;
+	ULONG64 image = 0;
+	ULONG frame;
+	ULONG x = 0;
+	ULONG y = 0;
+	LONG hue;
+	int result = EXIT_FAILURE;
+
+	test = &verify_cases[index];
+	source = base;
+
+	if (test->scale > 1)
+	{
+		if (!AtlasScaleSource (base, test->scale, &scaled))
+		{
+			fprintf (stderr, "out of memory for %s\n", test->name);
+
+			return EXIT_FAILURE;
+		}
+
+		source = &scaled;
+	}
+
+	matrix = CreateMatrix (GetRenderColumns (test->width, test->scale), GetRenderRows (test->height, test->scale), test->seed);
+	variant = CreateMatrix (GetRenderColumns (test->width, test->scale), GetRenderRows (test->height, test->scale), test->seed);
+
+	pixels = calloc ((SIZE_T)test->width * test->height, sizeof (ULONG));
+	variant_pixels = calloc ((SIZE_T)test->width * test->height, sizeof (ULONG));
+
+	if (!matrix || !variant || !pixels || !variant_pixels)
+	{
+		fprintf (stderr, "out of memory for %s\n", test->name);
+
+		goto CleanupExit;
+	}
+
+	matrix->density = variant->density = test->density;
+	matrix->amount = variant->amount = test->amount;
+
+	InitializeFramebuffer (&framebuffer, pixels, test->width, test->height, test->width);
+	InitializeFramebuffer (&variant_framebuffer, variant_pixels, test->width, test->height, test->width);
+	AtlasCacheInitialize (&cache, source);
+
+	kernel = GetRenderKernel (source->scale);
+
+	hue = VERIFY_HUE;
+
+	for (frame = 0; frame < test->frames; frame++)
+	{
+		if (test->is_smooth)
+			hue = (hue >= 255) ? 1 : hue + 1;
+
+		UpdateMatrix (matrix);
+		UpdateMatrixParallel (variant, pool);
+
+		atlas = AtlasCacheGet (&cache, hue);
+
+		if (!atlas)
+		{
+			status = "out_of_memory";
+
+			break;
+		}
+
+		RenderMatrix (matrix, &framebuffer, atlas, kernel);
+		RenderMatrix (variant, &variant_framebuffer, atlas, kernel);
+
+		ResetFramebufferDirty (&framebuffer);
+		ResetFramebufferDirty (&variant_framebuffer);
+
+		grid = HashMatrix (matrix);
+		image = HashFramebuffer (&framebuffer);
+
+		if (FindMatrixDifference (matrix, variant, &x, &y))
+		{
+			fprintf (
+				stderr,
+				"%s: frame %u, cell %u,%u is %04x in the reference and %04x in the variant\n",
+				test->name,
+				(unsigned)frame,
+				(unsigned)x,
+				(unsigned)y,
+				(unsigned)matrix->column[x].glyph[y],
+				(unsigned)variant->column[x].glyph[y]
+			);
+
+			status = "variant_grid";
+
+			break;
+		}
+
+		if (FindFramebufferDifference (&framebuffer, &variant_framebuffer, &x, &y))
+		{
+			fprintf (
+				stderr,
+				"%s: frame %u, pixel %u,%u (cell %u,%u) is %06x in the reference and %06x in the variant\n",
+				test->name,
+				(unsigned)frame,
+				(unsigned)x,
+				(unsigned)y,
+				(unsigned)(x / (GLYPH_WIDTH * source->scale)),
+				(unsigned)(y / (GLYPH_HEIGHT * source->scale)),
+				(unsigned)pixels[(SIZE_T)y * test->width + x],
+				(unsigned)variant_pixels[(SIZE_T)y * test->width + x]
+			);
+
+			status = "variant_frame";
+
+			break;
+		}
+
+		if (golden)
+		{
+			fprintf (golden, "%s %u %016llx %016llx\n", test->name, (unsigned)frame, (unsigned long long)grid, (unsigned long long)image);
+		}
+		else if (hashes)
+		{
+			hash = &hashes[GetVerifyHashIndex (index, frame)];
+
+			if (!hash->is_present)
+			{
+				fprintf (stderr, "%s: frame %u is not in the golden file\n", test->name, (unsigned)frame);
+
+				status = "golden_missing";
+
+				break;
+			}
+
+			// both runs agree, so the cell is not known, only the frame
+			if (hash->grid != grid)
+			{
+				fprintf (stderr, "%s: frame %u, grid hash is %016llx, golden %016llx\n", test->name, (unsigned)frame, (unsigned long long)grid, (unsigned long long)hash->grid);
+
+				status = "golden_grid";
+
+				break;
+			}
+
+			if (hash->image != image)
+			{
+				fprintf (stderr, "%s: frame %u, frame hash is %016llx, golden %016llx\n", test->name, (unsigned)frame, (unsigned long long)image, (unsigned long long)hash->image);
+
+				status = "golden_frame";
+
+				break;
+			}
+		}
+
+		// after the frame is drawn, the snapshot does not keep redraw state.
+		// a restore draws every glyph again in the current hue, so does the reference.
+		if (frame == test->frames / 2)
+		{
+			if (!RestoreVerifyMatrix (&variant))
+			{
+				status = "out_of_memory";
+
+				break;
+			}
+
+			InvalidateMatrix (matrix);
+		}
+	}
+
+	AtlasCacheDestroy (&cache);
+
+	printf (
+		"{\"case\":\"%s\",\"cols\":%u,\"rows\":%u,\"scale\":%u,\"frames\":%u,\"threads\":%u,\"status\":\"%s\",\"frame\":%u,\"grid_hash\":\"%016llx\",\"frame_hash\":\"%016llx\"}\n",
+		test->name,
+		(unsigned)matrix->numcols,
+		(unsigned)matrix->numrows,
+		(unsigned)test->scale,
+		(unsigned)test->frames,
+		pool ? (unsigned)pool->count : 1,
+		status,
+		(unsigned)((frame < test->frames) ? frame : test->frames - 1),
+		(unsigned long long)grid,
+		(unsigned long long)image
+	);
+
+	if (strcmp (status, "ok") == 0)
+		result = EXIT_SUCCESS;
+
+CleanupExit:
+
+	if (matrix)
+		DestroyMatrix (&matrix);
+
+	if (variant)
+		DestroyMatrix (&variant);
+
+	free (pixels);
+	free (variant_pixels);
+	free (scaled.pixels);
+
+	return result;
+}
+
+// the table is written on windows from the shell functions, without it
+// only the frames are checked
+static int RunVerifyHls (
+	_In_ const char *path
+)
+{
+	HLS_CHECK check;
+
+	check = CheckHlsTable (path);
+
+	printf ("{\"case\":\"hls\",\"table\":\"%s\",\"status\":\"%s\"}\n", path, GetHlsCheckName (check));
+
+	if (check == HlsCheckMissing)
+	{
+		fprintf (stderr, "%s not found, the hls conversion is not checked\n", path);
+
+		return EXIT_SUCCESS;
+	}
+
+	return (check == HlsCheckOk) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int RunVerify (
+	_In_ PVERIFY_OPTIONS options
+)
+{
+	ATLAS_SOURCE source;
+	PVERIFY_HASH hashes = NULL;
+	PWORKER_POOL pool = NULL;
+	FILE *golden = NULL;
+	int status = EXIT_SUCCESS;
+
+	// the golden hashes are of the real glyphs, generated ones would not match
+	if (!LoadAtlasSourceFile (options->atlas, &source))
+	{
+		fprintf (stderr, "cannot load %s\n", options->atlas);
+
+		return EXIT_FAILURE;
+	}
+
+	if (options->is_update)
+	{
+		golden = fopen (options->golden, "w");
+
+		if (!golden)
+		{
+			fprintf (stderr, "cannot open %s\n", options->golden);
+
+			free (source.pixels);
+
+			return EXIT_FAILURE;
+		}
+
+		fprintf (golden, "# matrix-headless verify, written by --update: <case> <frame> <grid hash> <frame hash>\n");
+	}
+	else
+	{
+		hashes = LoadVerifyGolden (options->golden);
+
+		if (!hashes)
+		{
+			free (source.pixels);
+
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (options->threads != 1)
+		pool = CreateWorkerPool (options->threads);
+
+	for (ULONG i = 0; i < RTL_NUMBER_OF (verify_cases); i++)
+	{
+		if (RunVerifyCase (pool, &source, i, hashes, golden) != EXIT_SUCCESS)
+			status = EXIT_FAILURE;
+	}
+
+	if (golden && fclose (golden) != 0)
+	{
+		fprintf (stderr, "write failed\n");
+
+		status = EXIT_FAILURE;
+	}
+
+	DestroyWorkerPool (&pool);
+	FlushMatrixPool ();
+
+	if (RunVerifyHls (options->hls) != EXIT_SUCCESS)
+		status = EXIT_FAILURE;
+
+	free (hashes);
+	free (source.pixels);
+
+	return status;
+}
@@ -0,0 +1,34 @@
+// Matrix Screensaver
+// Copyright (c) 2011-2026 Henry++
+
+#pragma once
+
+#include "platform.h"
+
+#include "hls.h"
+
+#define VERIFY_GOLDEN_DEFAULT "tools/golden.txt"
+#define VERIFY_ATLAS_DEFAULT "src/res/glyph.atlas"
+#define VERIFY_HLS_DEFAULT HLS_TABLE_DEFAULT
+#define VERIFY_THREADS_DEFAULT 4
+
+typedef struct _VERIFY_OPTIONS
+{
+	const char *golden;
+	const char *atlas;
+	const char *hls;
+	ULONG threads;
+	BOOLEAN is_update;
+} VERIFY_OPTIONS, *PVERIFY_OPTIONS;
+
+//
+// runs fixed seeds at several grid sizes twice: a reference with the
+// serial update, and a variant with the threaded update and a snapshot
+// round trip half way. the grids and frames of both runs are compared
+// every frame, and the hashes of the reference against the golden file.
+// prints one json object per case, returns EXIT_FAILURE on the first
+// difference of any case.
+//
+int RunVerify (
+	_In_ PVERIFY_OPTIONS options
+);